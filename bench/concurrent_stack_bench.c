@@ -0,0 +1,237 @@
+/*
+ * @file: concurrent_stack_bench.c
+ * @brief: Stress tests the lock-free cstack against concurrent pushes, pops
+ * and pop-alls, and compares its throughput with a mutex around a stack from
+ * 1 to 64 threads.
+ * @compile: "clang -O2 -pthread -o concurrent_stack_bench
+ * bench/concurrent_stack_bench.c concurrent_stack.c stacks.c dynamic_array.c
+ * large_alloc.c"
+ * @run: "./concurrent_stack_bench [ops_per_thread]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../concurrent_stack.h"
+#include "../stacks.h"
+
+#define BENCH_MAX_THREADS 64
+#define BENCH_POP_ALL_EVERY 4096
+
+typedef struct bench_shared {
+  cstack cs;
+  stack locked;
+  pthread_mutex_t lock;
+  pthread_barrier_t start;
+  long ops;
+  unsigned int threads;
+  // One bit per value any thread can push, set when the value is popped.
+  _Atomic uint64_t *seen;
+} bench_shared;
+
+typedef struct bench_thread {
+  bench_shared *shared;
+  pthread_t thread;
+  unsigned int id;
+  uint64_t pushed;
+  uint64_t popped;
+  int failed;
+} bench_thread;
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t bench_value(unsigned int id, long index) {
+  return ((uint64_t)id << 40) | (uint64_t)index;
+}
+
+static size_t bench_seen_words(long ops, unsigned int threads) {
+  return ((size_t)ops * threads + 63) / 64;
+}
+
+// Marks a popped value as seen; a value that is out of range or was already
+// seen fails the run.
+static void bench_collect(void *item, void *context) {
+  bench_thread *t = context;
+  bench_shared *shared = t->shared;
+  uint64_t value = *(uint64_t *)item;
+  unsigned int id = (unsigned int)(value >> 40);
+  uint64_t index = value & ((1ULL << 40) - 1);
+  t->popped++;
+  if (id >= shared->threads || index >= (uint64_t)shared->ops) {
+    t->failed = 1;
+    return;
+  }
+
+  size_t bit = (size_t)id * shared->ops + index;
+  uint64_t mask = 1ULL << (bit % 64);
+  if (atomic_fetch_or_explicit(&shared->seen[bit / 64], mask,
+                               memory_order_relaxed) &
+      mask)
+    t->failed = 1;
+}
+
+/*
+ * Every thread pushes values tagged with its id and pops twice for every two
+ * pushes, so the stack stays shallow and the top is contended. Every popped
+ * value is marked in a bitmap, and at the end every pushed value must have
+ * been popped exactly once.
+ */
+static void *bench_lock_free(void *arg) {
+  bench_thread *t = arg;
+  bench_shared *shared = t->shared;
+  cstack_local local;
+  cstack_local_init(&local);
+  pthread_barrier_wait(&shared->start);
+
+  for (long i = 0; i < shared->ops; i += 4) {
+    for (int j = 0; j < 2; j++) {
+      uint64_t value = bench_value(t->id, i + j);
+      if (cstack_push(&shared->cs, &local, &value) != CSTACK_SUCCESS) {
+        t->failed = 1;
+        return NULL;
+      }
+      t->pushed++;
+    }
+    for (int j = 0; j < 2; j++) {
+      uint64_t value;
+      if (cstack_pop(&shared->cs, &local, &value) == CSTACK_SUCCESS)
+        bench_collect(&value, t);
+    }
+    if (t->id == 0 && i % BENCH_POP_ALL_EVERY == 0)
+      cstack_pop_all(&shared->cs, &local, bench_collect, t);
+  }
+
+  cstack_local_flush(&shared->cs, &local);
+  return NULL;
+}
+
+static void *bench_mutex(void *arg) {
+  bench_thread *t = arg;
+  bench_shared *shared = t->shared;
+  pthread_barrier_wait(&shared->start);
+
+  for (long i = 0; i < shared->ops; i += 4) {
+    for (int j = 0; j < 2; j++) {
+      uint64_t value = bench_value(t->id, i + j);
+      pthread_mutex_lock(&shared->lock);
+      int result = stack_push(&shared->locked, &value);
+      pthread_mutex_unlock(&shared->lock);
+      if (result != STACK_SUCCESS) {
+        t->failed = 1;
+        return NULL;
+      }
+      t->pushed++;
+    }
+    for (int j = 0; j < 2; j++) {
+      uint64_t value;
+      pthread_mutex_lock(&shared->lock);
+      int result = stack_pop(&shared->locked, &value);
+      pthread_mutex_unlock(&shared->lock);
+      if (result == STACK_SUCCESS)
+        bench_collect(&value, t);
+    }
+  }
+  return NULL;
+}
+
+static int bench_run(const char *name, void *(*body)(void *),
+                     bench_shared *shared, unsigned int threads) {
+  bench_thread workers[BENCH_MAX_THREADS] = {0};
+  shared->threads = threads;
+  memset((void *)shared->seen, 0,
+         bench_seen_words(shared->ops, threads) * sizeof(uint64_t));
+  pthread_barrier_init(&shared->start, NULL, threads + 1);
+
+  for (unsigned int i = 0; i < threads; i++) {
+    workers[i].shared = shared;
+    workers[i].id = i;
+    pthread_create(&workers[i].thread, NULL, body, &workers[i]);
+  }
+
+  double begin = bench_now();
+  pthread_barrier_wait(&shared->start);
+  for (unsigned int i = 0; i < threads; i++)
+    pthread_join(workers[i].thread, NULL);
+  double elapsed = bench_now() - begin;
+  pthread_barrier_destroy(&shared->start);
+
+  // Drain whatever is left so every pushed value is accounted for.
+  bench_thread *rest = &workers[0];
+  uint64_t value;
+  if (body == bench_lock_free) {
+    while (cstack_pop(&shared->cs, NULL, &value) == CSTACK_SUCCESS)
+      bench_collect(&value, rest);
+  } else {
+    while (stack_pop(&shared->locked, &value) == STACK_SUCCESS)
+      bench_collect(&value, rest);
+  }
+
+  uint64_t pushed = 0, popped = 0;
+  int failed = 0;
+  for (unsigned int i = 0; i < threads; i++) {
+    pushed += workers[i].pushed;
+    popped += workers[i].popped;
+    failed |= workers[i].failed;
+  }
+
+  // No value was popped twice, so it is enough that every pushed value was
+  // popped once.
+  for (unsigned int id = 0; !failed && id < threads; id++)
+    for (long i = 0; i < shared->ops; i += 4)
+      for (int j = 0; j < 2; j++) {
+        size_t bit = (size_t)id * shared->ops + i + j;
+        if (!(atomic_load_explicit(&shared->seen[bit / 64],
+                                   memory_order_relaxed) &
+              (1ULL << (bit % 64))))
+          failed = 1;
+      }
+
+  int ok = !failed && pushed == popped;
+  printf("%-9s %7u %12.2f %s\n", name, threads,
+         (pushed + popped) / elapsed / 1e6, ok ? "ok" : "MISMATCH");
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  bench_shared shared;
+  shared.ops = (argc > 1) ? atol(argv[1]) : 400000;
+  // Threads work in rounds of four ops, and every pushed index is below ops.
+  shared.ops = (shared.ops + 3) / 4 * 4;
+
+  if (cstack_init(&shared.cs, sizeof(uint64_t)) != CSTACK_SUCCESS ||
+      stack_init(&shared.locked, sizeof(uint64_t)) != STACK_SUCCESS) {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+  shared.seen = calloc(bench_seen_words(shared.ops, BENCH_MAX_THREADS),
+                       sizeof(uint64_t));
+  if (shared.seen == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  pthread_mutex_init(&shared.lock, NULL);
+
+  int ok = 1;
+  printf("%-9s %7s %12s %s\n", "impl", "threads", "Mops/s", "check");
+  for (unsigned int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+    ok &= bench_run("lock-free", bench_lock_free, &shared, threads);
+    ok &= bench_run("mutex", bench_mutex, &shared, threads);
+  }
+
+  pthread_mutex_destroy(&shared.lock);
+  stack_free(&shared.locked);
+  cstack_free(&shared.cs);
+  free((void *)shared.seen);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+/*
+ * @file: concurrent_vector_bench.c
+ * @brief: Stress tests the lock-free cvec with many appending threads and a
+ * concurrent reader, and compares its append throughput, with and without
+ * per-thread batches, against a mutex around a dynamic_array from 1 to 64
+ * threads.
+ * @compile: "clang -O2 -pthread -o concurrent_vector_bench
+ * bench/concurrent_vector_bench.c concurrent_vector.c dynamic_array.c
+ * large_alloc.c"
+ * @run: "./concurrent_vector_bench [ops_per_thread]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../concurrent_vector.h"
+#include "../dynamic_array.h"
+
+#define BENCH_MAX_THREADS 64
+#define BENCH_BATCH 256
+
+enum bench_impl { BENCH_MUTEX, BENCH_LOCK_FREE, BENCH_BATCHED };
+
+typedef struct bench_shared {
+  cvec v;
+  dynamic_array locked;
+  pthread_mutex_t lock;
+  pthread_barrier_t start;
+  enum bench_impl impl;
+  long ops;
+  _Atomic int done;
+} bench_shared;
+
+typedef struct bench_thread {
+  bench_shared *shared;
+  pthread_t thread;
+  unsigned int id;
+  int failed;
+} bench_thread;
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Values are tagged with the thread id and counted from 1, so that an item
+// that reads as 0 was never written.
+#define bench_value(id, i) (((uint64_t)(id) << 40) | (uint64_t)((i) + 1))
+
+static void *bench_writer(void *arg) {
+  bench_thread *t = arg;
+  bench_shared *shared = t->shared;
+  cvec_local local;
+  if (shared->impl == BENCH_BATCHED &&
+      cvec_local_init(&shared->v, &local, BENCH_BATCH) != CVEC_SUCCESS)
+    t->failed = 1;
+  pthread_barrier_wait(&shared->start);
+  if (t->failed)
+    return NULL;
+
+  for (long i = 0; i < shared->ops; i++) {
+    uint64_t value = bench_value(t->id, i);
+    int result;
+    if (shared->impl == BENCH_MUTEX) {
+      pthread_mutex_lock(&shared->lock);
+      result = da_push(&shared->locked, &value);
+      pthread_mutex_unlock(&shared->lock);
+    } else {
+      result = cvec_push(&shared->v,
+                         (shared->impl == BENCH_BATCHED) ? &local : NULL,
+                         &value);
+    }
+    if (result != 0) {
+      t->failed = 1;
+      break;
+    }
+  }
+
+  if (shared->impl == BENCH_BATCHED) {
+    if (cvec_local_flush(&shared->v, &local) != CVEC_SUCCESS)
+      t->failed = 1;
+    cvec_local_free(&local);
+  }
+  return NULL;
+}
+
+/*
+ * Reads the newest published item over and over while the writers run; it
+ * must always have been written.
+ */
+static void *bench_reader(void *arg) {
+  bench_thread *t = arg;
+  bench_shared *shared = t->shared;
+  while (!atomic_load_explicit(&shared->done, memory_order_acquire)) {
+    size_t published = cvec_published(&shared->v);
+    uint64_t value;
+    if (published > 0 &&
+        (cvec_get(&shared->v, published - 1, &value) != CVEC_SUCCESS ||
+         value == 0))
+      t->failed = 1;
+  }
+  return NULL;
+}
+
+/*
+ * Every value must be there exactly once, and each thread's values must be in
+ * the order it pushed them.
+ */
+static int bench_check(bench_shared *shared, unsigned int threads) {
+  size_t count = (shared->impl == BENCH_MUTEX) ? shared->locked.count
+                                               : cvec_published(&shared->v);
+  if (count != (size_t)threads * shared->ops)
+    return 0;
+
+  long next[BENCH_MAX_THREADS] = {0};
+  for (size_t i = 0; i < count; i++) {
+    uint64_t value;
+    if (shared->impl == BENCH_MUTEX)
+      da_get_item(&shared->locked, i, &value);
+    else
+      cvec_get(&shared->v, i, &value);
+    unsigned int id = (unsigned int)(value >> 40);
+    if (id >= threads || value != bench_value(id, next[id]))
+      return 0;
+    next[id]++;
+  }
+  return 1;
+}
+
+static int bench_run(const char *name, enum bench_impl impl,
+                     bench_shared *shared, unsigned int threads) {
+  bench_thread workers[BENCH_MAX_THREADS + 1] = {0};
+  int ready = (impl == BENCH_MUTEX)
+                  ? da_init(&shared->locked, sizeof(uint64_t)) == DA_SUCCESS
+                  : cvec_init(&shared->v, sizeof(uint64_t)) == CVEC_SUCCESS;
+  if (!ready) {
+    fprintf(stderr, "init failed\n");
+    return 0;
+  }
+  shared->impl = impl;
+  atomic_store(&shared->done, 0);
+  pthread_barrier_init(&shared->start, NULL, threads + 1);
+
+  for (unsigned int i = 0; i < threads; i++) {
+    workers[i].shared = shared;
+    workers[i].id = i;
+    pthread_create(&workers[i].thread, NULL, bench_writer, &workers[i]);
+  }
+  bench_thread *reader = &workers[threads];
+  reader->shared = shared;
+  if (impl != BENCH_MUTEX)
+    pthread_create(&reader->thread, NULL, bench_reader, reader);
+
+  double begin = bench_now();
+  pthread_barrier_wait(&shared->start);
+  for (unsigned int i = 0; i < threads; i++)
+    pthread_join(workers[i].thread, NULL);
+  double elapsed = bench_now() - begin;
+  atomic_store_explicit(&shared->done, 1, memory_order_release);
+  if (impl != BENCH_MUTEX)
+    pthread_join(reader->thread, NULL);
+  pthread_barrier_destroy(&shared->start);
+
+  int failed = 0;
+  for (unsigned int i = 0; i <= threads; i++)
+    failed |= workers[i].failed;
+
+  int ok = !failed && bench_check(shared, threads);
+  printf("%-9s %7u %12.2f %s\n", name, threads,
+         (double)threads * shared->ops / elapsed / 1e6, ok ? "ok" : "MISMATCH");
+
+  if (impl == BENCH_MUTEX)
+    da_free(&shared->locked);
+  else
+    cvec_free(&shared->v);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  bench_shared shared;
+  shared.ops = (argc > 1) ? atol(argv[1]) : 1000000;
+  pthread_mutex_init(&shared.lock, NULL);
+
+  int ok = 1;
+  printf("%-9s %7s %12s %s\n", "impl", "threads", "Mpush/s", "check");
+  for (unsigned int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+    ok &= bench_run("mutex", BENCH_MUTEX, &shared, threads);
+    ok &= bench_run("lock-free", BENCH_LOCK_FREE, &shared, threads);
+    ok &= bench_run("batched", BENCH_BATCHED, &shared, threads);
+  }
+
+  pthread_mutex_destroy(&shared.lock);
+  return ok ? 0 : 1;
+}
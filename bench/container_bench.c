@@ -0,0 +1,489 @@
+/*
+ * @file: container_bench.c
+ * @brief: Benchmarks push, pop, insert-middle, remove-middle, random-get and
+ * sequential-scan on dynamic_array, stack, List and unrolled_list across item
+ * sizes and counts, and writes ns/op, p50/p99 latency, realloc count and peak
+ * RSS as CSV.
+ * @compile: "clang -O2 -pthread -o container_bench bench/container_bench.c
+ * dynamic_array.c large_alloc.c stacks.c singly_linked_list.c
+ * unrolled_linked_list.c"
+ * @run: "./container_bench [memory_budget_mib] > results.csv"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../dynamic_array.h"
+#include "../singly_linked_list.h"
+#include "../stacks.h"
+#include "../unrolled_linked_list.h"
+
+#define BENCH_DEFAULT_BUDGET_MIB 1024
+#define BENCH_MAX_SAMPLES 65536
+// Operations that walk or shift O(n) items are run at most this often, and
+// only as often as keeps them to about this many items touched in total.
+#define BENCH_LINEAR_OPS 1000
+#define BENCH_LINEAR_WORK 100000000ULL
+
+typedef struct bench_ctx {
+  size_t item_size;
+  size_t count;
+  dynamic_array da;
+  stack s;
+  List list;
+  sll_cursor cursor;
+  unrolled_list ull;
+  ull_cursor ull_cursor;
+  unsigned char *pool; // the items a List points to, one per node
+  unsigned char *item;
+  uint64_t rng;
+  uint64_t checksum;
+  size_t reallocs;
+  uint64_t *samples;
+} bench_ctx;
+
+typedef int (*bench_step_fn)(bench_ctx *ctx, size_t i);
+
+typedef struct bench_op {
+  const char *name;
+  bench_step_fn step;
+  int linear; // costs O(n) per call, so gets a capped number of calls
+} bench_op;
+
+typedef struct bench_container {
+  const char *name;
+  int (*init)(bench_ctx *ctx);
+  void (*free)(bench_ctx *ctx);
+  size_t (*footprint)(size_t item_size, size_t count);
+  bench_op ops[6];
+} bench_container;
+
+static uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t bench_random_index(bench_ctx *ctx, size_t bound) {
+  ctx->rng ^= ctx->rng << 13;
+  ctx->rng ^= ctx->rng >> 7;
+  ctx->rng ^= ctx->rng << 17;
+  return (size_t)(ctx->rng % bound);
+}
+
+/*
+ * The step functions below perform the i-th operation of a phase. Those that
+ * can resize storage count it in `reallocs` by watching the capacity (or, for
+ * List, the newest slab) change.
+ */
+static int da_step_push(bench_ctx *ctx, size_t i) {
+  ctx->item[0] = (unsigned char)i;
+  size_t capacity = ctx->da.capacity;
+  int result = da_push(&ctx->da, ctx->item);
+  ctx->reallocs += ctx->da.capacity != capacity;
+  return result;
+}
+
+static int da_step_pop(bench_ctx *ctx, size_t i) {
+  (void)i;
+  size_t capacity = ctx->da.capacity;
+  int result = da_pop_item(&ctx->da, ctx->item);
+  ctx->reallocs += ctx->da.capacity != capacity;
+  return result;
+}
+
+static int da_step_insert_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  size_t capacity = ctx->da.capacity;
+  int result = da_insert_item(&ctx->da, ctx->da.count / 2, ctx->item);
+  ctx->reallocs += ctx->da.capacity != capacity;
+  return result;
+}
+
+static int da_step_remove_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  size_t capacity = ctx->da.capacity;
+  int result = da_remove_item(&ctx->da, ctx->da.count / 2);
+  ctx->reallocs += ctx->da.capacity != capacity;
+  return result;
+}
+
+static int da_step_random_get(bench_ctx *ctx, size_t i) {
+  (void)i;
+  int result =
+      da_get_item(&ctx->da, bench_random_index(ctx, ctx->da.count), ctx->item);
+  ctx->checksum += ctx->item[0];
+  return result;
+}
+
+static int da_step_scan(bench_ctx *ctx, size_t i) {
+  int result = da_get_item(&ctx->da, i, ctx->item);
+  ctx->checksum += ctx->item[0];
+  return result;
+}
+
+static int stack_step_push(bench_ctx *ctx, size_t i) {
+  ctx->item[0] = (unsigned char)i;
+  size_t capacity = ctx->s.capacity;
+  int result = stack_push(&ctx->s, ctx->item);
+  ctx->reallocs += ctx->s.capacity != capacity;
+  return result;
+}
+
+static int stack_step_pop(bench_ctx *ctx, size_t i) {
+  (void)i;
+  size_t capacity = ctx->s.capacity;
+  int result = stack_pop(&ctx->s, ctx->item);
+  ctx->reallocs += ctx->s.capacity != capacity;
+  return result;
+}
+
+static int list_step_push(bench_ctx *ctx, size_t i) {
+  void *data = ctx->pool + i * ctx->item_size;
+  sll_slab *slab = ctx->list.slabs;
+  int result = (ctx->list.length == 0) ? sll_list_init(&ctx->list, data)
+                                       : sll_append_node(&ctx->list, data);
+  ctx->reallocs += ctx->list.slabs != slab;
+  return result;
+}
+
+static int list_step_pop(bench_ctx *ctx, size_t i) {
+  (void)i;
+  if (ctx->list.head == NULL)
+    return SLL_ERR_UNINIT;
+  memcpy(ctx->item, ctx->list.head->data, ctx->item_size);
+  return sll_delete_head(&ctx->list);
+}
+
+static int list_step_insert_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  sll_slab *slab = ctx->list.slabs;
+  int result = sll_insert_node(&ctx->list, ctx->list.length / 2, ctx->item);
+  ctx->reallocs += ctx->list.slabs != slab;
+  return result;
+}
+
+static int list_step_remove_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  return sll_delete_at_index(&ctx->list, ctx->list.length / 2);
+}
+
+static int list_step_random_get(bench_ctx *ctx, size_t i) {
+  (void)i;
+  Node *node = sll_get_at_index(
+      &ctx->list, bench_random_index(ctx, ctx->list.length));
+  if (node == NULL)
+    return SLL_ERR_INDEX;
+  memcpy(ctx->item, node->data, ctx->item_size);
+  ctx->checksum += ctx->item[0];
+  return SLL_SUCCESS;
+}
+
+static int list_step_scan(bench_ctx *ctx, size_t i) {
+  if (i == 0)
+    sll_cursor_init(&ctx->cursor, &ctx->list);
+  if (ctx->cursor.node == NULL)
+    return SLL_ERR_INDEX;
+  memcpy(ctx->item, ctx->cursor.node->data, ctx->item_size);
+  ctx->checksum += ctx->item[0];
+  return sll_cursor_next(&ctx->cursor);
+}
+
+/*
+ * A new node in the unrolled list is counted as a realloc, as a new slab is
+ * for List.
+ */
+static int ull_step_push(bench_ctx *ctx, size_t i) {
+  ctx->item[0] = (unsigned char)i;
+  ull_node *tail = ctx->ull.tail;
+  int result = ull_append_item(&ctx->ull, ctx->item);
+  ctx->reallocs += ctx->ull.tail != tail;
+  return result;
+}
+
+static int ull_step_pop(bench_ctx *ctx, size_t i) {
+  (void)i;
+  if (ull_get_item(&ctx->ull, 0, ctx->item) != ULL_SUCCESS)
+    return ULL_ERR_EMPTY;
+  return ull_delete_head(&ctx->ull);
+}
+
+static int ull_step_insert_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  ull_node *tail = ctx->ull.tail;
+  int result = ull_insert_item(&ctx->ull, ctx->ull.length / 2, ctx->item);
+  ctx->reallocs += ctx->ull.tail != tail;
+  return result;
+}
+
+static int ull_step_remove_middle(bench_ctx *ctx, size_t i) {
+  (void)i;
+  return ull_delete_at_index(&ctx->ull, ctx->ull.length / 2);
+}
+
+static int ull_step_random_get(bench_ctx *ctx, size_t i) {
+  (void)i;
+  int result = ull_get_item(
+      &ctx->ull, bench_random_index(ctx, ctx->ull.length), ctx->item);
+  ctx->checksum += ctx->item[0];
+  return result;
+}
+
+static int ull_step_scan(bench_ctx *ctx, size_t i) {
+  if (i == 0)
+    ull_cursor_init(&ctx->ull_cursor, &ctx->ull);
+  unsigned char *item = ull_cursor_get_ptr(&ctx->ull_cursor);
+  if (item == NULL)
+    return ULL_ERR_INDEX;
+  ctx->checksum += item[0];
+  return ull_cursor_next(&ctx->ull_cursor);
+}
+
+static int da_bench_init(bench_ctx *ctx) {
+  return da_init(&ctx->da, ctx->item_size);
+}
+
+static void da_bench_free(bench_ctx *ctx) { da_free(&ctx->da); }
+
+static int stack_bench_init(bench_ctx *ctx) {
+  return stack_init(&ctx->s, ctx->item_size);
+}
+
+static void stack_bench_free(bench_ctx *ctx) { stack_free(&ctx->s); }
+
+static int list_bench_init(bench_ctx *ctx) {
+  memset(&ctx->list, 0, sizeof(ctx->list));
+  ctx->pool = malloc(ctx->count * ctx->item_size);
+  if (ctx->pool == NULL)
+    return SLL_ERR_ALLOC;
+  for (size_t i = 0; i < ctx->count; i++)
+    ctx->pool[i * ctx->item_size] = (unsigned char)i;
+  return SLL_SUCCESS;
+}
+
+static void list_bench_free(bench_ctx *ctx) {
+  sll_free_list(&ctx->list);
+  free(ctx->pool);
+  ctx->pool = NULL;
+}
+
+static int ull_bench_init(bench_ctx *ctx) {
+  return ull_init(&ctx->ull, ctx->item_size);
+}
+
+static void ull_bench_free(bench_ctx *ctx) { ull_free(&ctx->ull); }
+
+// Growing by doubling through realloc can briefly need the old and new arrays.
+static size_t array_footprint(size_t item_size, size_t count) {
+  return 3 * item_size * count;
+}
+
+static size_t list_footprint(size_t item_size, size_t count) {
+  return (item_size + 2 * sizeof(Node)) * count;
+}
+
+// Nodes split by inserts can be as little as half full.
+static size_t ull_footprint(size_t item_size, size_t count) {
+  return 2 * item_size * count;
+}
+
+/*
+ * Operations run in table order on the same container: it is built by the
+ * first, restored by the insert/remove pair and emptied by the last. The
+ * stack only exposes its top, so it has push and pop alone.
+ */
+static const bench_container bench_containers[] = {
+    {"dynamic_array",
+     da_bench_init,
+     da_bench_free,
+     array_footprint,
+     {{"push", da_step_push, 0},
+      {"scan", da_step_scan, 0},
+      {"random_get", da_step_random_get, 0},
+      {"insert_middle", da_step_insert_middle, 1},
+      {"remove_middle", da_step_remove_middle, 1},
+      {"pop", da_step_pop, 0}}},
+    {"stack",
+     stack_bench_init,
+     stack_bench_free,
+     array_footprint,
+     {{"push", stack_step_push, 0}, {"pop", stack_step_pop, 0}}},
+    {"list",
+     list_bench_init,
+     list_bench_free,
+     list_footprint,
+     {{"push", list_step_push, 0},
+      {"scan", list_step_scan, 0},
+      {"random_get", list_step_random_get, 1},
+      {"insert_middle", list_step_insert_middle, 1},
+      {"remove_middle", list_step_remove_middle, 1},
+      {"pop", list_step_pop, 0}}},
+    {"unrolled_list",
+     ull_bench_init,
+     ull_bench_free,
+     ull_footprint,
+     {{"push", ull_step_push, 0},
+      {"scan", ull_step_scan, 0},
+      {"random_get", ull_step_random_get, 1},
+      {"insert_middle", ull_step_insert_middle, 1},
+      {"remove_middle", ull_step_remove_middle, 1},
+      {"pop", ull_step_pop, 0}}},
+};
+
+static const size_t bench_item_sizes[] = {4, 16, 64, 256, 1024};
+static const size_t bench_counts[] = {10, 1000, 100000, 10000000, 100000000};
+
+static int bench_compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static long bench_peak_rss_kb(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+/*
+ * Times every k-th of `ops` calls of `step` on its own for the latency
+ * percentiles, with k chosen so that at most BENCH_MAX_SAMPLES calls are
+ * sampled, and the rest as a whole for ns/op so that reading the clock around
+ * single calls does not inflate it. When every call is sampled, ns/op is
+ * their mean.
+ */
+static int bench_phase(bench_ctx *ctx, const char *container,
+                       const bench_op *op, size_t ops) {
+  size_t every = ops / BENCH_MAX_SAMPLES + 1;
+  size_t until_sample = 0;
+  size_t samples = 0;
+  uint64_t sampled_ns = 0;
+  int failed = 0;
+  ctx->reallocs = 0;
+
+  uint64_t begin = bench_now_ns();
+  for (size_t i = 0; i < ops; i++) {
+    if (until_sample-- == 0) {
+      uint64_t start = bench_now_ns();
+      failed |= op->step(ctx, i);
+      uint64_t end = bench_now_ns();
+      ctx->samples[samples++] = end - start;
+      sampled_ns += end - start;
+      until_sample = every - 1;
+    } else {
+      failed |= op->step(ctx, i);
+    }
+  }
+  uint64_t elapsed = bench_now_ns() - begin;
+  double ns_per_op = (ops > samples)
+                         ? (double)(elapsed - sampled_ns) / (ops - samples)
+                         : (samples ? (double)sampled_ns / samples : 0.0);
+
+  qsort(ctx->samples, samples, sizeof(uint64_t), bench_compare_u64);
+  uint64_t p50 = samples ? ctx->samples[samples / 2] : 0;
+  uint64_t p99 = samples ? ctx->samples[samples * 99 / 100] : 0;
+
+  printf("%s,%s,%zu,%zu,%zu,%.2f,%llu,%llu,%zu,%ld\n", container, op->name,
+         ctx->item_size, ctx->count, ops, ns_per_op,
+         (unsigned long long)p50, (unsigned long long)p99, ctx->reallocs,
+         bench_peak_rss_kb());
+  if (failed)
+    fprintf(stderr, "%s %s: an operation failed\n", container, op->name);
+  return failed;
+}
+
+static size_t bench_op_count(const bench_op *op, size_t count) {
+  if (!op->linear)
+    return count;
+  size_t ops = BENCH_LINEAR_WORK / count;
+  if (ops > BENCH_LINEAR_OPS)
+    ops = BENCH_LINEAR_OPS;
+  if (ops > count)
+    ops = count;
+  return ops ? ops : 1;
+}
+
+// Runs one configuration; called in a fresh child so peak RSS is its own.
+static int bench_config(const bench_container *container, size_t item_size,
+                        size_t count) {
+  bench_ctx ctx = {0};
+  ctx.item_size = item_size;
+  ctx.count = count;
+  ctx.rng = 0x9E3779B97F4A7C15ULL;
+  ctx.item = calloc(1, item_size);
+  ctx.samples = malloc(BENCH_MAX_SAMPLES * sizeof(uint64_t));
+  if (!ctx.item || !ctx.samples || container->init(&ctx) != 0) {
+    fprintf(stderr, "%s: init failed\n", container->name);
+    return 1;
+  }
+
+  int failed = 0;
+  size_t n_ops = sizeof(container->ops) / sizeof(container->ops[0]);
+  for (size_t i = 0; i < n_ops && container->ops[i].name; i++)
+    failed |= bench_phase(&ctx, container->name, &container->ops[i],
+                          bench_op_count(&container->ops[i], count));
+
+  container->free(&ctx);
+  free(ctx.item);
+  free(ctx.samples);
+  // Printing the checksum keeps the reads from being optimized away.
+  fprintf(stderr, "%s %zu x %zu done (checksum %llu)\n", container->name,
+          count, item_size, (unsigned long long)ctx.checksum);
+  return failed;
+}
+
+int main(int argc, char **argv) {
+  size_t budget_mib = (argc > 1) ? strtoull(argv[1], NULL, 10)
+                                 : BENCH_DEFAULT_BUDGET_MIB;
+  size_t budget = budget_mib << 20;
+
+  printf("container,op,item_size,count,ops,ns_per_op,p50_ns,p99_ns,reallocs,"
+         "peak_rss_kb\n");
+  fflush(stdout);
+
+  int ok = 1;
+  size_t n_containers = sizeof(bench_containers) / sizeof(bench_containers[0]);
+  size_t n_sizes = sizeof(bench_item_sizes) / sizeof(bench_item_sizes[0]);
+  size_t n_counts = sizeof(bench_counts) / sizeof(bench_counts[0]);
+
+  for (size_t c = 0; c < n_containers; c++) {
+    const bench_container *container = &bench_containers[c];
+    for (size_t s = 0; s < n_sizes; s++) {
+      for (size_t n = 0; n < n_counts; n++) {
+        size_t item_size = bench_item_sizes[s], count = bench_counts[n];
+        if (container->footprint(item_size, count) > budget) {
+          fprintf(stderr, "%s %zu x %zu skipped: over the %zu MiB budget\n",
+                  container->name, count, item_size, budget_mib);
+          continue;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+          perror("fork");
+          return 1;
+        }
+        if (pid == 0) {
+          int failed = bench_config(container, item_size, count);
+          fflush(stdout);
+          _exit(failed ? 1 : 0);
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+          fprintf(stderr, "%s %zu x %zu failed\n", container->name, count,
+                  item_size);
+          ok = 0;
+        }
+      }
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * @file: hash_map_bench.c
+ * @brief: Times inserts, hit and miss lookups and removes on the hash_map with
+ * 64-bit integer keys, through hm_put/hm_get and through HM_DEFINE, and checks
+ * every value read back.
+ * @compile: "clang -O2 -o hash_map_bench bench/hash_map_bench.c hash_map.c"
+ * @run: "./hash_map_bench [max_keys]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../hash_map.h"
+
+#define BENCH_LOOKUPS 4000000
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t bench_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static uint64_t bench_hash(const void *key, size_t size) {
+  (void)size;
+  uint64_t h = *(const uint64_t *)key;
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static int bench_equal(const void *a, const void *b, size_t size) {
+  (void)size;
+  return *(const uint64_t *)a == *(const uint64_t *)b;
+}
+
+HM_DEFINE(bench_map, uint64_t, bench_hash, bench_equal)
+
+// Multiplying by an odd constant is a bijection, so distinct indices give
+// distinct, well scattered keys; indices from `count` up are never inserted.
+static uint64_t bench_key(uint64_t index) {
+  return (index + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+typedef struct bench_times {
+  double insert;
+  double hit;
+  double miss;
+  double remove;
+} bench_times;
+
+/*
+ * Inserts `count` keys, each with the value index * 3, looks up random hits
+ * and misses, then removes every key. Returns 0 if any result or value is
+ * wrong, and the ns per op of every phase in `times`.
+ */
+static int bench_map_run(size_t count, int inlined, bench_times *times) {
+  hash_map map;
+  if (hm_init(&map, sizeof(uint64_t), sizeof(uint64_t), bench_hash,
+              bench_equal) != HM_SUCCESS)
+    return 0;
+
+  int ok = 1;
+  double begin = bench_now();
+  for (size_t i = 0; ok && i < count; i++) {
+    uint64_t key = bench_key(i), value = i * 3;
+    int result = inlined ? bench_map_put(&map, &key, &value)
+                         : hm_put(&map, &key, &value);
+    ok = result == HM_SUCCESS;
+  }
+  times->insert = (bench_now() - begin) / count * 1e9;
+  ok = ok && map.count == count;
+
+  uint64_t state = 88172645463325252ULL;
+  begin = bench_now();
+  for (long i = 0; ok && i < BENCH_LOOKUPS; i++) {
+    uint64_t index = bench_random(&state) % count;
+    uint64_t key = bench_key(index), value;
+    int result = inlined ? bench_map_get(&map, &key, &value)
+                         : hm_get(&map, &key, &value);
+    ok = result == HM_SUCCESS && value == index * 3;
+  }
+  times->hit = (bench_now() - begin) / BENCH_LOOKUPS * 1e9;
+
+  begin = bench_now();
+  for (long i = 0; ok && i < BENCH_LOOKUPS; i++) {
+    uint64_t key = bench_key(count + bench_random(&state) % count);
+    int result = inlined ? bench_map_get(&map, &key, NULL)
+                         : hm_get(&map, &key, NULL);
+    ok = result == HM_ERR_NOT_FOUND;
+  }
+  times->miss = (bench_now() - begin) / BENCH_LOOKUPS * 1e9;
+
+  begin = bench_now();
+  for (size_t i = 0; ok && i < count; i++) {
+    uint64_t key = bench_key(i);
+    int result =
+        inlined ? bench_map_remove(&map, &key) : hm_remove(&map, &key);
+    ok = result == HM_SUCCESS;
+  }
+  times->remove = (bench_now() - begin) / count * 1e9;
+  ok = ok && map.count == 0;
+
+  hm_free(&map);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  size_t max_keys = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+
+  int ok = 1;
+  printf("%-9s %9s %10s %10s %10s %10s %12s %s\n", "impl", "keys",
+         "insert ns", "hit ns", "miss ns", "remove ns", "hits M/s", "check");
+  for (size_t keys = 1000; keys <= max_keys; keys *= 10) {
+    for (int inlined = 0; inlined <= 1; inlined++) {
+      bench_times times = {0};
+      int run_ok = bench_map_run(keys, inlined, &times);
+      printf("%-9s %9zu %10.1f %10.1f %10.1f %10.1f %12.2f %s\n",
+             inlined ? "hm_define" : "hm", keys, times.insert, times.hit,
+             times.miss, times.remove, 1e3 / times.hit,
+             run_ok ? "ok" : "FAILED");
+      ok &= run_ok;
+    }
+  }
+  return ok ? 0 : 1;
+}
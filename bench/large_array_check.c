@@ -0,0 +1,150 @@
+/*
+ * @file: large_array_check.c
+ * @brief: Fills, scans and reads back arrays from da_init_large under each
+ * NUMA policy, next to a plain da_init array, growing each past its first
+ * mapping, and reports how many huge pages da_huge_pages found behind them.
+ * @compile: "clang -O2 -pthread -o large_array_check bench/large_array_check.c
+ * dynamic_array.c large_alloc.c"
+ * @run: "./large_array_check [mib]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../dynamic_array.h"
+
+#define CHECK_RANDOM_GETS 4000000
+
+typedef struct check_policy {
+  const char *name;
+  int large;
+  enum large_numa_policy numa;
+} check_policy;
+
+static const check_policy check_policies[] = {
+    {"da_init", 0, LARGE_NUMA_DEFAULT},
+    {"large_default", 1, LARGE_NUMA_DEFAULT},
+    {"large_interleave", 1, LARGE_NUMA_INTERLEAVE},
+    {"large_first_touch", 1, LARGE_NUMA_FIRST_TOUCH},
+};
+
+static double check_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t check_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static uint64_t check_value(uint64_t index) {
+  return index * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+// Prints the kernel's transparent huge page mode, e.g. "always [madvise]".
+static void check_print_thp(void) {
+  char mode[128] = "unknown";
+  FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (f != NULL) {
+    if (fgets(mode, sizeof(mode), f) != NULL)
+      mode[strcspn(mode, "\n")] = '\0';
+    fclose(f);
+  }
+  printf("transparent_hugepage: %s\n", mode);
+}
+
+/*
+ * Makes an array with room for half of `count` items, so that filling it
+ * grows it once, pushes `count` items, scans and randomly reads them back
+ * and checks every one. Returns 0 on a failure or a wrong item.
+ */
+static int check_run(const check_policy *policy, size_t count,
+                     unsigned int threads) {
+  dynamic_array da;
+  double begin = check_now();
+  int result = policy->large ? da_init_large(&da, sizeof(uint64_t), count / 2,
+                                             policy->numa, threads)
+                             : da_init(&da, sizeof(uint64_t));
+  double init_ms = (check_now() - begin) * 1e3;
+  if (result != DA_SUCCESS)
+    return 0;
+
+  int ok = 1;
+  begin = check_now();
+  for (size_t i = 0; ok && i < count; i++) {
+    uint64_t value = check_value(i);
+    ok = da_push(&da, &value) == DA_SUCCESS;
+  }
+  double push_ns = (check_now() - begin) / count * 1e9;
+
+  begin = check_now();
+  const uint64_t *items = da.items;
+  uint64_t sum = 0;
+  for (size_t i = 0; ok && i < count; i++)
+    sum += items[i];
+  double scan_ns = (check_now() - begin) / count * 1e9;
+
+  uint64_t expected = 0;
+  for (size_t i = 0; ok && i < count; i++) {
+    expected += check_value(i);
+    ok = items[i] == check_value(i);
+  }
+  ok = ok && sum == expected && da.count == count;
+
+  uint64_t state = 88172645463325252ULL;
+  begin = check_now();
+  for (long i = 0; ok && i < CHECK_RANDOM_GETS; i++) {
+    size_t index = check_random(&state) % count;
+    uint64_t value;
+    ok = da_get_item(&da, index, &value) == DA_SUCCESS &&
+         value == check_value(index);
+  }
+  double get_ns = (check_now() - begin) / CHECK_RANDOM_GETS * 1e9;
+
+  // Huge pages are only a request, so getting none isn't a failure.
+  char pages_text[32] = "-";
+  size_t pages;
+  if (policy->large) {
+    ok = ok && da_huge_pages(&da, &pages) == DA_SUCCESS;
+    size_t bytes = large_round(da.capacity * da.item_size);
+    snprintf(pages_text, sizeof(pages_text), "%zu/%zu", ok ? pages : 0,
+             bytes / LARGE_PAGE_SIZE);
+  }
+
+  printf("%-17s %9.1f %8.2f %8.2f %8.2f %11s %s\n", policy->name, init_ms,
+         push_ns, scan_ns, get_ns, pages_text, ok ? "ok" : "FAILED");
+  da_free(&da);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  size_t mib = (argc > 1) ? strtoull(argv[1], NULL, 10) : 512;
+  size_t count = (mib << 20) / sizeof(uint64_t);
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int threads = (cpus > 0) ? (unsigned int)cpus : 1;
+  if (count < 2) {
+    fprintf(stderr, "need at least 1 MiB\n");
+    return 1;
+  }
+
+  check_print_thp();
+  printf("%zu MiB of uint64_t, %u first-touch threads\n", mib, threads);
+  printf("%-17s %9s %8s %8s %8s %11s %s\n", "impl", "init ms", "push ns",
+         "scan ns", "get ns", "huge pages", "check");
+
+  int ok = 1;
+  for (size_t i = 0; i < sizeof(check_policies) / sizeof(check_policies[0]);
+       i++)
+    ok &= check_run(&check_policies[i], count, threads);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+/*
+ * @file: list_algorithms_bench.c
+ * @brief: Times sll_sort against copying the node pointers into an array for
+ * qsort, sll_merge_sorted against splicing the lists together and sorting,
+ * and the skip list's insert and get by index against the plain List's, and
+ * checks every result against the expected order.
+ * @compile: "clang -O2 -o list_algorithms_bench bench/list_algorithms_bench.c
+ * singly_linked_list.c"
+ * @run: "./list_algorithms_bench [max_count]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../singly_linked_list.h"
+
+// Operations that walk a plain List are run at most this often.
+#define BENCH_LINEAR_OPS 2000
+// Up to this count the skip list is checked against an array, which costs
+// O(count^2) to build.
+#define BENCH_CHECK_LIMIT 100000
+
+// `seq` numbers the items in list order before sorting, so a stable sort
+// leaves equal keys in increasing `seq`.
+typedef struct bench_item {
+  uint32_t key;
+  uint32_t seq;
+} bench_item;
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t bench_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static int bench_cmp_key(const void *a, const void *b) {
+  uint32_t x = ((const bench_item *)a)->key, y = ((const bench_item *)b)->key;
+  return (x > y) - (x < y);
+}
+
+// qsort isn't stable, so the array baseline breaks ties on `seq` itself.
+static int bench_cmp_node_ptr(const void *a, const void *b) {
+  const bench_item *x = (*(Node *const *)a)->data;
+  const bench_item *y = (*(Node *const *)b)->data;
+  if (x->key != y->key)
+    return (x->key > y->key) - (x->key < y->key);
+  return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static int bench_build(List *list, bench_item *items, size_t count) {
+  int ok = sll_list_init(list, &items[0]) == SLL_SUCCESS;
+  for (size_t i = 1; ok && i < count; i++)
+    ok = sll_append_node(list, &items[i]) == SLL_SUCCESS;
+  return ok;
+}
+
+// Sorted by key, equal keys in `seq` order, and `count` nodes ending at tail.
+static int bench_check(List *list, size_t count) {
+  if (list->length != count)
+    return 0;
+
+  size_t seen = 0;
+  const bench_item *previous = NULL;
+  for (Node *node = list->head; node != NULL; node = node->next, seen++) {
+    const bench_item *item = node->data;
+    if (previous != NULL &&
+        (previous->key > item->key ||
+         (previous->key == item->key && previous->seq > item->seq)))
+      return 0;
+    if (node->next == NULL && node != list->tail)
+      return 0;
+    previous = item;
+  }
+  return seen == count;
+}
+
+/*
+ * Random keys with about four copies of each, numbered in list order.
+ */
+static void bench_fill(bench_item *items, size_t count, uint64_t *state) {
+  for (size_t i = 0; i < count; i++) {
+    items[i].key = (uint32_t)(bench_random(state) % (count / 4 + 1));
+    items[i].seq = (uint32_t)i;
+  }
+}
+
+static double bench_sort_list(bench_item *items, size_t count, int *ok) {
+  List list;
+  if (!bench_build(&list, items, count)) {
+    *ok = 0;
+    return 0;
+  }
+
+  double begin = bench_now();
+  *ok &= sll_sort(&list, bench_cmp_key) == SLL_SUCCESS;
+  double elapsed = bench_now() - begin;
+
+  *ok &= bench_check(&list, count);
+  sll_free_list(&list);
+  return elapsed;
+}
+
+// The way to sort a List before sll_sort: out to an array and back.
+static double bench_sort_array(bench_item *items, size_t count, int *ok) {
+  List list;
+  Node **nodes = malloc(count * sizeof(Node *));
+  if (nodes == NULL || !bench_build(&list, items, count)) {
+    free(nodes);
+    *ok = 0;
+    return 0;
+  }
+
+  double begin = bench_now();
+  size_t n = 0;
+  for (Node *node = list.head; node != NULL; node = node->next)
+    nodes[n++] = node;
+  qsort(nodes, n, sizeof(Node *), bench_cmp_node_ptr);
+  for (size_t i = 0; i + 1 < n; i++)
+    nodes[i]->next = nodes[i + 1];
+  nodes[n - 1]->next = NULL;
+  list.head = nodes[0];
+  list.tail = nodes[n - 1];
+  double elapsed = bench_now() - begin;
+
+  *ok &= bench_check(&list, count);
+  sll_free_list(&list);
+  free(nodes);
+  return elapsed;
+}
+
+/*
+ * Splits `count` items into `k` sorted lists. The keys are dealt out at
+ * random, so each list covers the whole key range, and numbered list by list
+ * so that a stable merge keeps equal keys in `seq` order.
+ */
+static int bench_build_runs(List *lists, size_t k, bench_item *items,
+                            size_t count, uint64_t *state) {
+  size_t keys = count / 4 + 1;
+  for (size_t i = 0; i < count; i++)
+    items[i].key = (uint32_t)(bench_random(state) % keys);
+
+  size_t first = 0;
+  for (size_t l = 0; l < k; l++) {
+    size_t last = count * (l + 1) / k;
+    if (!bench_build(&lists[l], items + first, last - first) ||
+        sll_sort(&lists[l], bench_cmp_key) != SLL_SUCCESS)
+      return 0;
+    for (Node *node = lists[l].head; node != NULL; node = node->next)
+      ((bench_item *)node->data)->seq = (uint32_t)first++;
+  }
+  return 1;
+}
+
+/*
+ * Merges into the first of the lists, which sll_merge_sorted allows, and
+ * checks that the others come out empty.
+ */
+static double bench_merge_heap(List *lists, size_t k, size_t count, int *ok) {
+  double begin = bench_now();
+  *ok &= sll_merge_sorted(&lists[0], lists, k, bench_cmp_key) == SLL_SUCCESS;
+  double elapsed = bench_now() - begin;
+
+  *ok &= bench_check(&lists[0], count);
+  for (size_t l = 1; l < k; l++)
+    *ok &= lists[l].head == NULL && lists[l].length == 0;
+  sll_free_list(&lists[0]);
+  return elapsed;
+}
+
+static double bench_merge_resort(List *lists, size_t k, size_t count,
+                                 int *ok) {
+  double begin = bench_now();
+  sll_cursor cursor;
+  sll_cursor_init(&cursor, &lists[0]);
+  while (cursor.node != NULL)
+    sll_cursor_next(&cursor);
+  for (size_t l = 1; l < k; l++) {
+    *ok &= sll_cursor_splice(&cursor, &lists[l]) == SLL_SUCCESS;
+    while (cursor.node != NULL)
+      sll_cursor_next(&cursor);
+  }
+  *ok &= sll_sort(&lists[0], bench_cmp_key) == SLL_SUCCESS;
+  double elapsed = bench_now() - begin;
+
+  *ok &= bench_check(&lists[0], count);
+  sll_free_list(&lists[0]);
+  return elapsed;
+}
+
+static int bench_report(const char *phase, const char *impl, size_t count,
+                        size_t k, double ns_per_op, int ok) {
+  printf("%-6s %-12s %9zu %4zu %10.1f %s\n", phase, impl, count, k, ns_per_op,
+         ok ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+ * Builds a skip list by inserting `count` ids at random indexes, then reads
+ * random indexes back. The plain List gets the same list of ids and fewer
+ * operations, as each of its costs O(n). Up to BENCH_CHECK_LIMIT the skip
+ * list is checked against an array built with the same inserts.
+ */
+static int bench_skip(size_t count, uint64_t *state) {
+  uint32_t *ids = malloc(count * sizeof(uint32_t));
+  size_t *at = malloc(count * sizeof(size_t));
+  uint32_t *model = malloc(count * sizeof(uint32_t));
+  sll_skip_list skip;
+  if (!ids || !at || !model || sll_skip_init(&skip, 0, 0, NULL)) {
+    free(ids);
+    free(at);
+    free(model);
+    return 0;
+  }
+  for (size_t i = 0; i < count; i++) {
+    ids[i] = (uint32_t)i;
+    at[i] = (size_t)(bench_random(state) % (i + 1));
+  }
+
+  int ok = 1;
+  double begin = bench_now();
+  for (size_t i = 0; i < count; i++)
+    ok &= sll_skip_insert_at(&skip, at[i], &ids[i]) == SLL_SUCCESS;
+  double insert_skip = (bench_now() - begin) / count * 1e9;
+
+  begin = bench_now();
+  for (size_t i = 0; i < count; i++)
+    ok &= sll_skip_get_at_index(&skip, bench_random(state) % count) != NULL;
+  double get_skip = (bench_now() - begin) / count * 1e9;
+
+  if (count <= BENCH_CHECK_LIMIT) {
+    for (size_t i = 0; i < count; i++) {
+      memmove(model + at[i] + 1, model + at[i],
+              (i - at[i]) * sizeof(uint32_t));
+      model[at[i]] = ids[i];
+    }
+    size_t i = 0;
+    for (Node *node = skip.list.head; ok && node != NULL; node = node->next)
+      ok = i < count && *(uint32_t *)node->data == model[i++];
+    ok = ok && i == count && skip.list.length == count;
+    for (size_t j = 0; ok && j < 1000; j++) {
+      size_t index = bench_random(state) % count;
+      Node *node = sll_skip_get_at_index(&skip, index);
+      ok = node != NULL && *(uint32_t *)node->data == model[index];
+    }
+  }
+
+  // The plain List gets the same order, and fewer of the same operations.
+  List list;
+  Node *node = skip.list.head;
+  ok &= sll_list_init(&list, node->data) == SLL_SUCCESS;
+  for (node = node->next; node != NULL; node = node->next)
+    ok &= sll_append_node(&list, node->data) == SLL_SUCCESS;
+
+  size_t linear = (count < BENCH_LINEAR_OPS) ? count : BENCH_LINEAR_OPS;
+  begin = bench_now();
+  for (size_t i = 0; i < linear; i++)
+    ok &= sll_get_at_index(&list, bench_random(state) % count) != NULL;
+  double get_list = (bench_now() - begin) / linear * 1e9;
+
+  begin = bench_now();
+  for (size_t i = 0; i < linear; i++)
+    ok &= sll_insert_node(&list, bench_random(state) % (count + i),
+                          &ids[i]) == SLL_SUCCESS;
+  double insert_list = (bench_now() - begin) / linear * 1e9;
+
+  bench_report("skip", "skip_insert", count, 1, insert_skip, ok);
+  bench_report("skip", "list_insert", count, 1, insert_list, ok);
+  bench_report("skip", "skip_get", count, 1, get_skip, ok);
+  bench_report("skip", "list_get", count, 1, get_list, ok);
+
+  sll_free_list(&list);
+  sll_skip_free(&skip);
+  free(ids);
+  free(at);
+  free(model);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  size_t max_count = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+  static const size_t ks[] = {2, 8, 64};
+  List lists[64];
+
+  bench_item *items = malloc(max_count * sizeof(bench_item));
+  if (items == NULL) {
+    printf("Could not allocate %zu items\n", max_count);
+    return 1;
+  }
+
+  int ok = 1;
+  printf("%-6s %-12s %9s %4s %10s %s\n", "phase", "impl", "count", "k",
+         "ns/op", "check");
+  for (size_t count = 1000; count <= max_count; count *= 10) {
+    uint64_t state = 88172645463325252ULL;
+    int good = 1;
+
+    bench_fill(items, count, &state);
+    double seconds = bench_sort_list(items, count, &good);
+    ok &= bench_report("sort", "sll_sort", count, 1, seconds / count * 1e9,
+                       good);
+    good = 1;
+    seconds = bench_sort_array(items, count, &good);
+    ok &= bench_report("sort", "array_qsort", count, 1,
+                       seconds / count * 1e9, good);
+
+    for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); i++) {
+      size_t k = ks[i];
+      uint64_t runs_state = state;
+      good = bench_build_runs(lists, k, items, count, &runs_state);
+      seconds = good ? bench_merge_heap(lists, k, count, &good) : 0;
+      ok &= bench_report("merge", "heap", count, k, seconds / count * 1e9,
+                         good);
+
+      runs_state = state;
+      good = bench_build_runs(lists, k, items, count, &runs_state);
+      seconds = good ? bench_merge_resort(lists, k, count, &good) : 0;
+      ok &= bench_report("merge", "splice_sort", count, k,
+                         seconds / count * 1e9, good);
+    }
+
+    ok &= bench_skip(count, &state);
+  }
+
+  free(items);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+/*
+ * @file: mapped_array_check.c
+ * @brief: Checks file-backed dynamic arrays from da_map_file: creating and
+ * reopening a file, a corrupted item caught by da_verify, a wrong item_size,
+ * read-only opens, and reopening after pushes that a crashed process never
+ * checkpointed.
+ * @compile: "clang -O2 -pthread -o mapped_array_check
+ * bench/mapped_array_check.c dynamic_array.c large_alloc.c"
+ * @run: "./mapped_array_check [path]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../dynamic_array.h"
+
+#define CHECK_ITEMS 100000
+#define CHECK_UNSAVED 50000
+// Items start right after the file's 64-byte header.
+#define CHECK_HEADER_SIZE 64
+
+static uint64_t check_value(uint64_t index) {
+  return index * 0x9E3779B97F4A7C15ULL + 7;
+}
+
+static int check_report(const char *name, int ok) {
+  printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// Whether `da` holds exactly check_value(0) ... check_value(count - 1).
+static int check_items(dynamic_array *da, size_t count) {
+  if (da->count != count || da->item_size != sizeof(uint64_t))
+    return 0;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t value;
+    if (da_get_item(da, i, &value) != DA_SUCCESS || value != check_value(i))
+      return 0;
+  }
+  return 1;
+}
+
+static int check_exists(const char *path) { return access(path, F_OK) == 0; }
+
+static int check_create(const char *path) {
+  dynamic_array da;
+  unlink(path);
+  if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_WRITE) !=
+      DA_SUCCESS)
+    return 0;
+
+  int ok = da.count == 0;
+  for (uint64_t i = 0; ok && i < CHECK_ITEMS; i++) {
+    uint64_t value = check_value(i);
+    ok = da_push(&da, &value) == DA_SUCCESS;
+  }
+  ok = ok && check_items(&da, CHECK_ITEMS) &&
+       da_checkpoint(&da) == DA_SUCCESS && da_verify(&da) == DA_SUCCESS;
+  da_free(&da);
+  return ok;
+}
+
+static int check_reopen(const char *path) {
+  dynamic_array da;
+  if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_WRITE) !=
+      DA_SUCCESS)
+    return 0;
+  int ok = check_items(&da, CHECK_ITEMS) && da_verify(&da) == DA_SUCCESS;
+  da_free(&da);
+
+  // An item_size of 0 takes the file's.
+  if (da_map_file(&da, path, 0, DA_FILE_READ_WRITE) != DA_SUCCESS)
+    return 0;
+  ok = ok && check_items(&da, CHECK_ITEMS);
+  da_free(&da);
+  return ok;
+}
+
+// A wrong item_size or a file that isn't an array is refused, and neither
+// file is removed.
+static int check_format(const char *path, const char *other) {
+  dynamic_array da;
+  int ok = da_map_file(&da, path, sizeof(uint32_t), DA_FILE_READ_WRITE) ==
+               DA_ERR_FORMAT &&
+           check_exists(path);
+
+  int fd = open(other, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 0;
+  ok = ok && write(fd, "not an array", 12) == 12;
+  close(fd);
+  ok = ok && da_map_file(&da, other, sizeof(uint64_t), DA_FILE_READ_WRITE) ==
+                 DA_ERR_FORMAT &&
+       check_exists(other);
+  unlink(other);
+
+  // Creating a file without an item_size fails and leaves no file behind.
+  ok = ok && da_map_file(&da, other, 0, DA_FILE_READ_WRITE) == DA_ERR_UNINIT &&
+       !check_exists(other);
+  return ok && check_reopen(path);
+}
+
+static int check_read_only(const char *path, const char *other) {
+  dynamic_array da;
+  unlink(other);
+  int ok = da_map_file(&da, other, sizeof(uint64_t), DA_FILE_READ_ONLY) ==
+               DA_ERR_IO &&
+           !check_exists(other);
+
+  if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_ONLY) !=
+      DA_SUCCESS)
+    return 0;
+  uint64_t value = 0;
+  ok = ok && check_items(&da, CHECK_ITEMS) && da_verify(&da) == DA_SUCCESS &&
+       da_push(&da, &value) == DA_ERR_READONLY &&
+       da_set_item(&da, 0, &value) == DA_ERR_READONLY &&
+       da_insert_item(&da, 0, &value) == DA_ERR_READONLY &&
+       da_remove_item(&da, 0) == DA_ERR_READONLY &&
+       da_pop_item(&da, &value) == DA_ERR_READONLY &&
+       da_checkpoint(&da) == DA_ERR_READONLY &&
+       check_items(&da, CHECK_ITEMS);
+  da_free(&da);
+  return ok;
+}
+
+// Flips one byte of an item in the file behind the mapping's back.
+static int check_flip(const char *path, size_t index) {
+  int fd = open(path, O_RDWR);
+  if (fd < 0)
+    return 0;
+  off_t offset = CHECK_HEADER_SIZE + (off_t)(index * sizeof(uint64_t));
+  unsigned char byte;
+  int ok = pread(fd, &byte, 1, offset) == 1;
+  byte ^= 0x40;
+  ok = ok && pwrite(fd, &byte, 1, offset) == 1;
+  close(fd);
+  return ok;
+}
+
+static int check_corrupt(const char *path) {
+  dynamic_array da;
+  if (!check_flip(path, CHECK_ITEMS / 2) ||
+      da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_ONLY) !=
+          DA_SUCCESS)
+    return 0;
+  int ok = da_verify(&da) == DA_ERR_FORMAT;
+  da_free(&da);
+
+  // Flipping it back makes the array whole again.
+  if (!check_flip(path, CHECK_ITEMS / 2) ||
+      da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_ONLY) !=
+          DA_SUCCESS)
+    return 0;
+  ok = ok && da_verify(&da) == DA_SUCCESS && check_items(&da, CHECK_ITEMS);
+  da_free(&da);
+  return ok;
+}
+
+/*
+ * A child process pushes more items, enough to grow the file, and exits
+ * without a checkpoint as if it had crashed. The file must still read back
+ * as the last checkpoint, and take new pushes after it.
+ */
+static int check_crash(const char *path) {
+  pid_t child = fork();
+  if (child < 0)
+    return 0;
+  if (child == 0) {
+    dynamic_array da;
+    if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_WRITE) !=
+        DA_SUCCESS)
+      _exit(1);
+    for (uint64_t i = 0; i < CHECK_UNSAVED; i++) {
+      uint64_t value = ~check_value(i);
+      if (da_push(&da, &value) != DA_SUCCESS)
+        _exit(1);
+    }
+    _exit(0);
+  }
+
+  int status;
+  if (waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0)
+    return 0;
+
+  dynamic_array da;
+  if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_WRITE) !=
+      DA_SUCCESS)
+    return 0;
+  int ok = check_items(&da, CHECK_ITEMS) && da_verify(&da) == DA_SUCCESS &&
+           da.capacity >= CHECK_ITEMS + CHECK_UNSAVED;
+  uint64_t value = check_value(CHECK_ITEMS);
+  ok = ok && da_push(&da, &value) == DA_SUCCESS;
+  da_free(&da);
+
+  if (da_map_file(&da, path, sizeof(uint64_t), DA_FILE_READ_ONLY) !=
+      DA_SUCCESS)
+    return 0;
+  ok = ok && check_items(&da, CHECK_ITEMS + 1) && da_verify(&da) == DA_SUCCESS;
+  da_free(&da);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  const char *path = (argc > 1) ? argv[1] : "mapped_array_check.dat";
+  char other[4096];
+  snprintf(other, sizeof(other), "%s.other", path);
+
+  int ok = check_report("create, push and checkpoint", check_create(path));
+  ok = ok && check_report("reopen", check_reopen(path));
+  ok = ok && check_report("wrong item_size and format",
+                          check_format(path, other));
+  ok = ok && check_report("read-only open", check_read_only(path, other));
+  ok = ok && check_report("corrupted item", check_corrupt(path));
+  ok = ok && check_report("reopen after unsaved pushes", check_crash(path));
+
+  unlink(path);
+  unlink(other);
+  return ok ? 0 : 1;
+}
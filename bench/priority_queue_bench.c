@@ -0,0 +1,160 @@
+/*
+ * @file: priority_queue_bench.c
+ * @brief: Compares the d-ary heap priority_queue, through pq_pop/pq_push and
+ * through PQ_DEFINE, against a List kept sorted by insertion, on the hold
+ * model (pop the smallest key, push it back larger) at queue sizes up to 1M.
+ * @compile: "clang -O2 -pthread -o priority_queue_bench
+ * bench/priority_queue_bench.c priority_queue.c dynamic_array.c large_alloc.c
+ * singly_linked_list.c"
+ * @run: "./priority_queue_bench [max_size]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../priority_queue.h"
+#include "../singly_linked_list.h"
+
+#define BENCH_HEAP_OPS 2000000
+// A sorted insert walks half the list, so the List gets far fewer ops.
+#define BENCH_LIST_HOPS 400000000ULL
+#define BENCH_ARITY 4
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t bench_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static int bench_cmp(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+PQ_DEFINE(bench_pq, bench_cmp)
+
+/*
+ * Fills a queue with `size` random keys, then pops the smallest and pushes it
+ * back larger by a random amount `ops` times. The popped keys must never
+ * decrease. Returns ns per pop + push, or -1 on a failure or wrong order.
+ */
+static double bench_heap(size_t size, long ops, int inlined) {
+  priority_queue pq;
+  if (pq_init(&pq, sizeof(uint64_t), BENCH_ARITY, bench_cmp, 0) != PQ_SUCCESS)
+    return -1;
+
+  uint64_t state = 88172645463325252ULL;
+  for (size_t i = 0; i < size; i++) {
+    uint64_t key = bench_random(&state) % (size * 4);
+    if (pq_push(&pq, &key, NULL) != PQ_SUCCESS)
+      return -1;
+  }
+
+  int ok = 1;
+  uint64_t previous = 0;
+  double begin = bench_now();
+  for (long i = 0; i < ops; i++) {
+    uint64_t key;
+    int popped = inlined ? bench_pq_pop(&pq, &key) : pq_pop(&pq, &key);
+    ok &= popped == PQ_SUCCESS && key >= previous;
+    previous = key;
+    key += 1 + bench_random(&state) % size;
+    int pushed = inlined ? bench_pq_push(&pq, &key, NULL)
+                         : pq_push(&pq, &key, NULL);
+    ok &= pushed == PQ_SUCCESS;
+  }
+  double elapsed = bench_now() - begin;
+
+  pq_free(&pq);
+  return ok ? elapsed / ops * 1e9 : -1;
+}
+
+// Inserts `key` after every key not larger than it.
+static int bench_list_insert(List *list, uint64_t *key) {
+  if (*key < *(uint64_t *)list->head->data)
+    return sll_prepend_node(list, key);
+
+  sll_cursor cursor;
+  sll_cursor_init(&cursor, list);
+  while (cursor.node->next != NULL &&
+         *(uint64_t *)cursor.node->next->data <= *key)
+    sll_cursor_next(&cursor);
+  return sll_cursor_insert_after(&cursor, key);
+}
+
+/*
+ * The same hold model on a List kept sorted, with the smallest key at the
+ * head. List nodes only point to their data, so the keys live in `keys`, one
+ * slot per key ever pushed.
+ */
+static double bench_list(size_t size, long ops) {
+  uint64_t *keys = malloc((size + ops) * sizeof(uint64_t));
+  if (keys == NULL)
+    return -1;
+
+  // Sorted random keys with the same spread as the heap's, built by
+  // appending so that filling doesn't cost O(size^2).
+  uint64_t state = 88172645463325252ULL;
+  keys[0] = 0;
+  for (size_t i = 1; i < size; i++)
+    keys[i] = keys[i - 1] + bench_random(&state) % 8;
+
+  List list;
+  int ok = sll_list_init(&list, &keys[0]) == SLL_SUCCESS;
+  for (size_t i = 1; ok && i < size; i++)
+    ok = sll_append_node(&list, &keys[i]) == SLL_SUCCESS;
+
+  uint64_t previous = 0;
+  double begin = bench_now();
+  for (long i = 0; ok && i < ops; i++) {
+    uint64_t key = *(uint64_t *)list.head->data;
+    ok = sll_delete_head(&list) == SLL_SUCCESS && key >= previous;
+    previous = key;
+    uint64_t *next = &keys[size + i];
+    *next = key + 1 + bench_random(&state) % size;
+    ok = ok && bench_list_insert(&list, next) == SLL_SUCCESS;
+  }
+  double elapsed = bench_now() - begin;
+
+  sll_free_list(&list);
+  free(keys);
+  return ok ? elapsed / ops * 1e9 : -1;
+}
+
+static int bench_report(const char *name, size_t size, long ops,
+                        double ns_per_op) {
+  printf("%-12s %9zu %9ld %12.1f %s\n", name, size, ops,
+         ns_per_op < 0 ? 0 : ns_per_op, ns_per_op < 0 ? "FAILED" : "ok");
+  return ns_per_op >= 0;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+
+  int ok = 1;
+  printf("%-12s %9s %9s %12s %s\n", "impl", "size", "ops", "ns/op", "check");
+  for (size_t size = 1000; size <= max_size; size *= 10) {
+    long list_ops = (long)(BENCH_LIST_HOPS / size);
+    if (list_ops > BENCH_HEAP_OPS)
+      list_ops = BENCH_HEAP_OPS;
+
+    ok &= bench_report("pq", size, BENCH_HEAP_OPS,
+                       bench_heap(size, BENCH_HEAP_OPS, 0));
+    ok &= bench_report("pq_define", size, BENCH_HEAP_OPS,
+                       bench_heap(size, BENCH_HEAP_OPS, 1));
+    ok &= bench_report("sorted_list", size, list_ops,
+                       bench_list(size, list_ops));
+  }
+  return ok ? 0 : 1;
+}
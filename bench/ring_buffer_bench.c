@@ -0,0 +1,239 @@
+/*
+ * @file: ring_buffer_bench.c
+ * @brief: Measures throughput and enqueue-to-dequeue latency percentiles of
+ * the SPSC and MPMC rings with threads pinned to cores, and checks that every
+ * item arrives exactly once (and in order, for SPSC).
+ * @compile: "clang -O2 -pthread -o ring_buffer_bench bench/ring_buffer_bench.c
+ * ring_buffer.c"
+ * @run: "./ring_buffer_bench [items] [first_cpu] [mpmc_threads_per_side]"
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../ring_buffer.h"
+
+#define BENCH_CAPACITY 4096
+#define BENCH_BATCH 32
+#define BENCH_SAMPLE_EVERY 64
+#define BENCH_MAX_THREADS 32
+
+typedef struct bench_item {
+  uint64_t sequence;
+  uint64_t stamp;
+} bench_item;
+
+typedef struct bench_config {
+  spsc_ring spsc;
+  mpmc_ring mpmc;
+  int use_mpmc;
+  size_t batch;
+  uint64_t items;
+  unsigned int producers;
+  unsigned int consumers;
+  int first_cpu;
+  pthread_barrier_t start;
+  _Atomic uint64_t consumed;
+} bench_config;
+
+typedef struct bench_thread {
+  bench_config *config;
+  pthread_t thread;
+  unsigned int id;
+  int cpu;
+  uint64_t sum;
+  uint64_t count;
+  int out_of_order;
+  uint64_t *latencies;
+  size_t latency_count;
+} bench_thread;
+
+static uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void bench_pin(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    fprintf(stderr, "warning: could not pin thread to cpu %d\n", cpu);
+}
+
+static size_t bench_enqueue(bench_config *c, bench_item *items, size_t n) {
+  return c->use_mpmc ? mpmc_ring_enqueue_batch(&c->mpmc, items, n)
+                     : spsc_ring_enqueue_batch(&c->spsc, items, n);
+}
+
+static size_t bench_dequeue(bench_config *c, bench_item *items, size_t n) {
+  return c->use_mpmc ? mpmc_ring_dequeue_batch(&c->mpmc, items, n)
+                     : spsc_ring_dequeue_batch(&c->spsc, items, n);
+}
+
+// Producers split the sequence numbers [0, items) between them.
+static void *bench_producer(void *arg) {
+  bench_thread *t = arg;
+  bench_config *c = t->config;
+  bench_pin(t->cpu);
+  pthread_barrier_wait(&c->start);
+
+  bench_item batch[BENCH_BATCH];
+  for (uint64_t next = t->id; next < c->items;) {
+    size_t n = 0;
+    while (n < c->batch && next < c->items) {
+      batch[n].sequence = next;
+      batch[n].stamp = (next % BENCH_SAMPLE_EVERY == 0) ? bench_now_ns() : 0;
+      next += c->producers;
+      n++;
+    }
+    size_t sent = 0;
+    while (sent < n)
+      sent += bench_enqueue(c, batch + sent, n - sent);
+  }
+  return NULL;
+}
+
+static void *bench_consumer(void *arg) {
+  bench_thread *t = arg;
+  bench_config *c = t->config;
+  bench_pin(t->cpu);
+  pthread_barrier_wait(&c->start);
+
+  bench_item batch[BENCH_BATCH];
+  uint64_t expected = 0;
+  while (atomic_load_explicit(&c->consumed, memory_order_relaxed) < c->items) {
+    size_t n = bench_dequeue(c, batch, c->batch);
+    if (n == 0)
+      continue;
+
+    uint64_t now = bench_now_ns();
+    for (size_t i = 0; i < n; i++) {
+      if (!c->use_mpmc && batch[i].sequence != expected++)
+        t->out_of_order = 1;
+      if (batch[i].stamp != 0)
+        t->latencies[t->latency_count++] = now - batch[i].stamp;
+      t->sum += batch[i].sequence;
+      t->count++;
+    }
+    atomic_fetch_add_explicit(&c->consumed, n, memory_order_relaxed);
+  }
+  return NULL;
+}
+
+static int bench_compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int bench_run(bench_config *c, const char *name) {
+  bench_thread producers[BENCH_MAX_THREADS] = {0};
+  bench_thread consumers[BENCH_MAX_THREADS] = {0};
+  int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int cpu = c->first_cpu;
+
+  atomic_store(&c->consumed, 0);
+  pthread_barrier_init(&c->start, NULL, c->producers + c->consumers + 1);
+
+  for (unsigned int i = 0; i < c->consumers; i++) {
+    consumers[i].config = c;
+    consumers[i].cpu = cpu++ % cpus;
+    consumers[i].latencies =
+        malloc((c->items / BENCH_SAMPLE_EVERY + 1) * sizeof(uint64_t));
+    pthread_create(&consumers[i].thread, NULL, bench_consumer, &consumers[i]);
+  }
+  for (unsigned int i = 0; i < c->producers; i++) {
+    producers[i].config = c;
+    producers[i].id = i;
+    producers[i].cpu = cpu++ % cpus;
+    pthread_create(&producers[i].thread, NULL, bench_producer, &producers[i]);
+  }
+
+  uint64_t begin = bench_now_ns();
+  pthread_barrier_wait(&c->start);
+  for (unsigned int i = 0; i < c->producers; i++)
+    pthread_join(producers[i].thread, NULL);
+  for (unsigned int i = 0; i < c->consumers; i++)
+    pthread_join(consumers[i].thread, NULL);
+  double elapsed = (bench_now_ns() - begin) / 1e9;
+  pthread_barrier_destroy(&c->start);
+
+  uint64_t count = 0, sum = 0;
+  size_t samples = 0;
+  int out_of_order = 0;
+  for (unsigned int i = 0; i < c->consumers; i++) {
+    count += consumers[i].count;
+    sum += consumers[i].sum;
+    samples += consumers[i].latency_count;
+    out_of_order |= consumers[i].out_of_order;
+  }
+
+  uint64_t *latencies = malloc((samples + 1) * sizeof(uint64_t));
+  size_t filled = 0;
+  for (unsigned int i = 0; i < c->consumers; i++) {
+    for (size_t j = 0; j < consumers[i].latency_count; j++)
+      latencies[filled++] = consumers[i].latencies[j];
+    free(consumers[i].latencies);
+  }
+  qsort(latencies, samples, sizeof(uint64_t), bench_compare_u64);
+
+  uint64_t expected_sum = c->items * (c->items - 1) / 2;
+  int ok = count == c->items && sum == expected_sum && !out_of_order;
+  printf("%-5s %5zu %4u/%-4u %10.2f %8llu %8llu %8llu %s\n", name, c->batch,
+         c->producers, c->consumers, count / elapsed / 1e6,
+         (unsigned long long)(samples ? latencies[samples / 2] : 0),
+         (unsigned long long)(samples ? latencies[samples * 99 / 100] : 0),
+         (unsigned long long)(samples ? latencies[samples * 999 / 1000] : 0),
+         ok ? "ok" : "MISMATCH");
+  free(latencies);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  bench_config c;
+  c.items = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000000;
+  c.first_cpu = (argc > 2) ? atoi(argv[2]) : 0;
+  unsigned int side = (argc > 3) ? (unsigned int)atoi(argv[3]) : 2;
+  if (side == 0 || side > BENCH_MAX_THREADS)
+    side = 2;
+
+  if (spsc_ring_init(&c.spsc, sizeof(bench_item), BENCH_CAPACITY) !=
+          RING_SUCCESS ||
+      mpmc_ring_init(&c.mpmc, sizeof(bench_item), BENCH_CAPACITY) !=
+          RING_SUCCESS) {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+
+  int ok = 1;
+  printf("%-5s %5s %9s %10s %8s %8s %8s %s\n", "ring", "batch", "prod/cons",
+         "Mops/s", "p50 ns", "p99 ns", "p999 ns", "check");
+  size_t batches[] = {1, BENCH_BATCH};
+  for (size_t b = 0; b < 2; b++) {
+    c.batch = batches[b];
+
+    c.use_mpmc = 0;
+    c.producers = 1;
+    c.consumers = 1;
+    ok &= bench_run(&c, "spsc");
+
+    c.use_mpmc = 1;
+    ok &= bench_run(&c, "mpmc");
+
+    c.producers = side;
+    c.consumers = side;
+    ok &= bench_run(&c, "mpmc");
+  }
+
+  spsc_ring_free(&c.spsc);
+  mpmc_ring_free(&c.mpmc);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+/*
+ * @file: unrolled_list_check.c
+ * @brief: Runs random inserts, deletes and writes on an unrolled_list and on a
+ * plain array model side by side, for several item sizes, and checks after
+ * every step batch that get, the cursor and ull_for_each all read back the
+ * model, and that every node but the last stays at least half full.
+ * @compile: "clang -O2 -o unrolled_list_check bench/unrolled_list_check.c
+ * unrolled_linked_list.c"
+ * @run: "./unrolled_list_check [steps]"
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../unrolled_linked_list.h"
+
+#define CHECK_MAX_ITEM 200
+#define CHECK_EVERY 97
+
+typedef struct check_ctx {
+  const uint32_t *model;
+  size_t item_size;
+  size_t next;
+  int ok;
+} check_ctx;
+
+static uint64_t check_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// The bytes of the item with id `id`; every id fills its item differently.
+static void check_fill(unsigned char *item, size_t item_size, uint32_t id) {
+  for (size_t j = 0; j < item_size; j++)
+    item[j] = (unsigned char)((id >> (8 * (j % 4))) + j / 4 * 131);
+}
+
+static void check_visit(void *items, size_t count, void *arg) {
+  check_ctx *ctx = arg;
+  unsigned char expected[CHECK_MAX_ITEM];
+  for (size_t i = 0; i < count; i++, ctx->next++) {
+    check_fill(expected, ctx->item_size, ctx->model[ctx->next]);
+    if (memcmp((unsigned char *)items + i * ctx->item_size, expected,
+               ctx->item_size) != 0)
+      ctx->ok = 0;
+  }
+}
+
+static int check_list(unrolled_list *list, const uint32_t *model,
+                      size_t length) {
+  if (list->length != length)
+    return 0;
+
+  size_t counted = 0;
+  for (ull_node *node = list->head; node != NULL; node = node->next) {
+    counted += node->count;
+    if (node->count == 0 || node->count > list->node_capacity)
+      return 0;
+    if (node->next == NULL && node != list->tail)
+      return 0;
+  }
+  if (counted != length)
+    return 0;
+
+  unsigned char expected[CHECK_MAX_ITEM], item[CHECK_MAX_ITEM];
+  ull_cursor cursor;
+  ull_cursor_init(&cursor, list);
+  for (size_t i = 0; i < length; i++) {
+    check_fill(expected, list->item_size, model[i]);
+    void *at = ull_cursor_get_ptr(&cursor);
+    if (at == NULL || memcmp(at, expected, list->item_size) != 0)
+      return 0;
+    ull_cursor_next(&cursor);
+    if (i % 13 == 0 && (ull_get_item(list, i, item) != ULL_SUCCESS ||
+                        memcmp(item, expected, list->item_size) != 0))
+      return 0;
+  }
+  if (ull_cursor_get_ptr(&cursor) != NULL ||
+      ull_cursor_next(&cursor) != ULL_ERR_INDEX)
+    return 0;
+
+  check_ctx ctx = {model, list->item_size, 0, 1};
+  ull_for_each(list, check_visit, &ctx);
+  return ctx.ok && ctx.next == length;
+}
+
+// Deleting keeps every node but the last at least half full.
+static int check_packing(unrolled_list *list) {
+  for (ull_node *node = list->head; node != NULL && node->next != NULL;
+       node = node->next)
+    if (node->count < list->node_capacity / 2)
+      return 0;
+  return 1;
+}
+
+static int check_run(size_t item_size, long steps) {
+  unrolled_list list;
+  if (ull_init(&list, item_size) != ULL_SUCCESS)
+    return 0;
+
+  uint32_t *model = malloc(steps * sizeof(uint32_t));
+  if (model == NULL)
+    return 0;
+  size_t length = 0;
+  uint32_t id = 0;
+  uint64_t state = 0x9E3779B97F4A7C15ULL ^ item_size;
+  unsigned char item[CHECK_MAX_ITEM];
+  int ok = 1, packed = 1;
+
+  for (long step = 0; ok && step < steps; step++) {
+    uint64_t r = check_random(&state);
+    // Grow for the first half of the run and shrink in the second, so the
+    // list both fills up and drains.
+    int grow = (r % 100) < ((step < steps / 2) ? 65u : 35u);
+    size_t at = length ? (size_t)((r >> 8) % length) : 0;
+
+    if (grow || length == 0) {
+      check_fill(item, item_size, ++id);
+      int result;
+      switch ((r >> 40) % 3) {
+      case 0:
+        result = ull_append_item(&list, item);
+        at = length;
+        break;
+      case 1:
+        result = ull_prepend_item(&list, item);
+        at = 0;
+        break;
+      default:
+        result = ull_insert_item(&list, at, item);
+      }
+      ok = result == ULL_SUCCESS;
+      memmove(model + at + 1, model + at, (length - at) * sizeof(uint32_t));
+      model[at] = id;
+      length++;
+    } else if ((r >> 40) % 4 == 0) {
+      check_fill(item, item_size, ++id);
+      ok = ull_set_item(&list, at, item) == ULL_SUCCESS;
+      model[at] = id;
+    } else {
+      int result;
+      switch ((r >> 40) % 3) {
+      case 0:
+        result = ull_delete_head(&list);
+        at = 0;
+        break;
+      case 1:
+        result = ull_delete_tail(&list);
+        at = length - 1;
+        break;
+      default:
+        result = ull_delete_at_index(&list, at);
+      }
+      ok = result == ULL_SUCCESS;
+      memmove(model + at, model + at + 1,
+              (length - at - 1) * sizeof(uint32_t));
+      length--;
+      packed &= check_packing(&list);
+    }
+
+    if (step % CHECK_EVERY == 0 || step == steps - 1)
+      ok = ok && check_list(&list, model, length);
+  }
+
+  ok = ok && ull_get_item(&list, length, item) == ULL_ERR_INDEX;
+  printf("item_size %4zu: node_capacity %3zu, %s%s\n", item_size,
+         list.node_capacity, ok ? "ok" : "MISMATCH",
+         packed ? "" : " (a node fell below half full)");
+
+  ull_free(&list);
+  free(model);
+  return ok && packed;
+}
+
+int main(int argc, char **argv) {
+  long steps = (argc > 1) ? atol(argv[1]) : 200000;
+  static const size_t item_sizes[] = {1, 4, 24, 64, 100, CHECK_MAX_ITEM};
+
+  int ok = 1;
+  for (size_t i = 0; i < sizeof(item_sizes) / sizeof(item_sizes[0]); i++)
+    ok &= check_run(item_sizes[i], steps);
+  return ok ? 0 : 1;
+}
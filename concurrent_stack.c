@@ -0,0 +1,318 @@
+/*
+ * @file: concurrent_stack.c
+ * @brief: Implements a lock-free (Treiber) stack that any number of threads
+ * can push to and pop from at the same time.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "concurrent_stack.h"
+
+char *cstack_get_error_string(enum cstack_errors error) {
+  switch (error) {
+  case CSTACK_SUCCESS:
+    return "SUCCESS";
+  case CSTACK_ERR_NULL:
+    return "NULL_PARAMETER";
+  case CSTACK_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case CSTACK_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case CSTACK_ERR_EMPTY:
+    return "STACK_EMPTY";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+/*
+ * Nodes are never handed back to the system while the stack is alive. They
+ * live in chunks that double in size and never move, and are addressed by a
+ * 32-bit index (0 meaning "none"). That makes it safe for a thread to read the
+ * `next` of a node another thread has just popped, and lets each stack top be
+ * a single 64-bit word: the index in the low half and a tag in the high half
+ * that changes on every update, so a CAS can't succeed on a top that was
+ * popped and pushed back in between (the ABA problem).
+ *
+ * Free nodes go back on a second Treiber stack, and a thread can keep a small
+ * cstack_local cache of them so that most pushes and pops touch only the one
+ * shared word they need.
+ */
+#define cstack_pack(index, tag) (((uint64_t)(tag) << 32) | (uint32_t)(index))
+#define cstack_index(word) ((uint32_t)(word))
+#define cstack_tag(word) ((uint32_t)((word) >> 32))
+
+int cstack_init(cstack *s, size_t item_size) {
+  if (!s)
+    return CSTACK_ERR_NULL;
+  if (item_size == 0)
+    return CSTACK_ERR_UNINIT;
+
+  atomic_init(&s->top, 0);
+  atomic_init(&s->free_top, 0);
+  atomic_init(&s->fresh, 1);
+  for (size_t i = 0; i < CSTACK_MAX_CHUNKS; i++)
+    atomic_init(&s->chunks[i], NULL);
+
+  s->item_size = item_size;
+  s->node_size = (sizeof(_Atomic uint32_t) + item_size + 7) & ~(size_t)7;
+  return CSTACK_SUCCESS;
+}
+
+int cstack_local_init(cstack_local *local) {
+  if (!local)
+    return CSTACK_ERR_NULL;
+  local->count = 0;
+  return CSTACK_SUCCESS;
+}
+
+// Chunk k holds 2^(k + CSTACK_FIRST_CHUNK_SHIFT) nodes; indexes start at 1.
+static size_t cstack_chunk_of(uint32_t index, size_t *offset) {
+  uint64_t position = (uint64_t)index - 1 + (1u << CSTACK_FIRST_CHUNK_SHIFT);
+  size_t bit = 63 - __builtin_clzll(position);
+  *offset = position - ((uint64_t)1 << bit);
+  return bit - CSTACK_FIRST_CHUNK_SHIFT;
+}
+
+static unsigned char *cstack_node(cstack *s, uint32_t index) {
+  size_t offset;
+  size_t chunk = cstack_chunk_of(index, &offset);
+  unsigned char *base =
+      atomic_load_explicit(&s->chunks[chunk], memory_order_acquire);
+  return base + offset * s->node_size;
+}
+
+#define cstack_next(node) ((_Atomic uint32_t *)(node))
+#define cstack_item(node) ((node) + sizeof(_Atomic uint32_t))
+
+// Links the chain first..last (already joined through `next`) onto `top`.
+static void cstack_push_chain(cstack *s, _Atomic uint64_t *top, uint32_t first,
+                              uint32_t last) {
+  unsigned char *tail = cstack_node(s, last);
+  uint64_t old = atomic_load_explicit(top, memory_order_relaxed);
+  do {
+    atomic_store_explicit(cstack_next(tail), cstack_index(old),
+                          memory_order_relaxed);
+  } while (!atomic_compare_exchange_weak_explicit(
+      top, &old, cstack_pack(first, cstack_tag(old) + 1), memory_order_release,
+      memory_order_relaxed));
+}
+
+static uint32_t cstack_pop_node(cstack *s, _Atomic uint64_t *top) {
+  uint64_t old = atomic_load_explicit(top, memory_order_acquire);
+  while (cstack_index(old) != 0) {
+    unsigned char *node = cstack_node(s, cstack_index(old));
+    uint32_t next = atomic_load_explicit(cstack_next(node), memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(
+            top, &old, cstack_pack(next, cstack_tag(old) + 1),
+            memory_order_acquire, memory_order_acquire))
+      return cstack_index(old);
+  }
+  return 0;
+}
+
+/*
+ * Pops up to `max` nodes into `nodes` with a single CAS, walking them first.
+ * The walk may read `next` links that another thread is changing, but any
+ * such change pops or pushes on `top` and so bumps its tag, which makes the
+ * CAS fail and the walk start again.
+ */
+static size_t cstack_pop_nodes(cstack *s, _Atomic uint64_t *top,
+                               uint32_t *nodes, size_t max) {
+  uint64_t old = atomic_load_explicit(top, memory_order_acquire);
+  while (cstack_index(old) != 0) {
+    size_t count = 0;
+    uint32_t index = cstack_index(old);
+    while (index != 0 && count < max) {
+      nodes[count++] = index;
+      index = atomic_load_explicit(cstack_next(cstack_node(s, index)),
+                                   memory_order_relaxed);
+    }
+    if (atomic_compare_exchange_weak_explicit(
+            top, &old, cstack_pack(index, cstack_tag(old) + 1),
+            memory_order_acquire, memory_order_acquire))
+      return count;
+  }
+  return 0;
+}
+
+// Detaches the whole chain from `top` and returns its first node.
+static uint32_t cstack_take_all(_Atomic uint64_t *top) {
+  uint64_t old = atomic_load_explicit(top, memory_order_acquire);
+  while (cstack_index(old) != 0) {
+    if (atomic_compare_exchange_weak_explicit(
+            top, &old, cstack_pack(0, cstack_tag(old) + 1),
+            memory_order_acquire, memory_order_acquire))
+      return cstack_index(old);
+  }
+  return 0;
+}
+
+/*
+ * Hands out the next never-used index. `fresh` stops at UINT32_MAX instead of
+ * wrapping round to 0 ("none") and to indexes that are still in use, so the
+ * last index given out is UINT32_MAX - 1.
+ */
+static uint32_t cstack_fresh_node(cstack *s) {
+  uint32_t index = atomic_load_explicit(&s->fresh, memory_order_relaxed);
+  do {
+    if (index == UINT32_MAX)
+      return 0;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &s->fresh, &index, index + 1, memory_order_relaxed,
+      memory_order_relaxed));
+
+  size_t offset;
+  size_t chunk = cstack_chunk_of(index, &offset);
+  if (atomic_load_explicit(&s->chunks[chunk], memory_order_acquire) != NULL)
+    return index;
+
+  // Several threads may race to allocate the same chunk; the loser frees its
+  // copy.
+  size_t nodes = (size_t)1 << (chunk + CSTACK_FIRST_CHUNK_SHIFT);
+  unsigned char *base = malloc(nodes * s->node_size);
+  if (base == NULL)
+    return 0;
+
+  unsigned char *expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&s->chunks[chunk], &expected,
+                                               base, memory_order_acq_rel,
+                                               memory_order_acquire))
+    free(base);
+  return index;
+}
+
+static uint32_t cstack_alloc_node(cstack *s, cstack_local *local) {
+  if (local == NULL) {
+    uint32_t index = cstack_pop_node(s, &s->free_top);
+    return (index != 0) ? index : cstack_fresh_node(s);
+  }
+
+  if (local->count == 0) {
+    // Refill half the cache from the shared free list in one go, falling back
+    // to a fresh node when it is empty.
+    local->count = cstack_pop_nodes(s, &s->free_top, local->nodes,
+                                    CSTACK_LOCAL_NODES / 2);
+    if (local->count == 0)
+      return cstack_fresh_node(s);
+  }
+
+  return local->nodes[--local->count];
+}
+
+static void cstack_release_node(cstack *s, cstack_local *local,
+                                uint32_t index) {
+  if (local == NULL) {
+    cstack_push_chain(s, &s->free_top, index, index);
+    return;
+  }
+
+  if (local->count == CSTACK_LOCAL_NODES) {
+    // Hand half of the cache back to the shared free list as one chain.
+    size_t keep = CSTACK_LOCAL_NODES / 2;
+    for (size_t i = keep; i + 1 < local->count; i++)
+      atomic_store_explicit(cstack_next(cstack_node(s, local->nodes[i])),
+                            local->nodes[i + 1], memory_order_relaxed);
+    cstack_push_chain(s, &s->free_top, local->nodes[keep],
+                      local->nodes[local->count - 1]);
+    local->count = keep;
+  }
+
+  local->nodes[local->count++] = index;
+}
+
+/*
+ * `local` is the calling thread's node cache and may be NULL, in which case
+ * nodes come from and go back to the shared free list directly.
+ */
+int cstack_push(cstack *s, cstack_local *local, void *item) {
+  if (!s || !item)
+    return CSTACK_ERR_NULL;
+  if (s->item_size == 0)
+    return CSTACK_ERR_UNINIT;
+
+  uint32_t index = cstack_alloc_node(s, local);
+  if (index == 0)
+    return CSTACK_ERR_ALLOC;
+
+  memcpy(cstack_item(cstack_node(s, index)), item, s->item_size);
+  cstack_push_chain(s, &s->top, index, index);
+  return CSTACK_SUCCESS;
+}
+
+int cstack_pop(cstack *s, cstack_local *local, void *item) {
+  if (!s || !item)
+    return CSTACK_ERR_NULL;
+  if (s->item_size == 0)
+    return CSTACK_ERR_UNINIT;
+
+  uint32_t index = cstack_pop_node(s, &s->top);
+  if (index == 0)
+    return CSTACK_ERR_EMPTY;
+
+  memcpy(item, cstack_item(cstack_node(s, index)), s->item_size);
+  cstack_release_node(s, local, index);
+  return CSTACK_SUCCESS;
+}
+
+/*
+ * Detaches every item on the stack with a single atomic operation and passes
+ * them to `visit` from top to bottom. Returns CSTACK_ERR_EMPTY when there was
+ * nothing to take.
+ */
+int cstack_pop_all(cstack *s, cstack_local *local,
+                   void (*visit)(void *item, void *context), void *context) {
+  if (!s || !visit)
+    return CSTACK_ERR_NULL;
+  if (s->item_size == 0)
+    return CSTACK_ERR_UNINIT;
+
+  uint32_t index = cstack_take_all(&s->top);
+  if (index == 0)
+    return CSTACK_ERR_EMPTY;
+
+  while (index != 0) {
+    unsigned char *node = cstack_node(s, index);
+    uint32_t next = atomic_load_explicit(cstack_next(node), memory_order_relaxed);
+    visit(cstack_item(node), context);
+    cstack_release_node(s, local, index);
+    index = next;
+  }
+  return CSTACK_SUCCESS;
+}
+
+// Returns a thread's cached nodes to the shared free list, e.g. before exit.
+int cstack_local_flush(cstack *s, cstack_local *local) {
+  if (!s || !local)
+    return CSTACK_ERR_NULL;
+
+  for (size_t i = 0; i < local->count; i++)
+    cstack_push_chain(s, &s->free_top, local->nodes[i], local->nodes[i]);
+  local->count = 0;
+  return CSTACK_SUCCESS;
+}
+
+// Not thread-safe: every other thread must be done with the stack.
+void cstack_free(cstack *s) {
+  if (!s)
+    return;
+
+  for (size_t i = 0; i < CSTACK_MAX_CHUNKS; i++) {
+    free(atomic_load(&s->chunks[i]));
+    atomic_store(&s->chunks[i], NULL);
+  }
+  atomic_store(&s->top, 0);
+  atomic_store(&s->free_top, 0);
+  atomic_store(&s->fresh, 1);
+  s->item_size = 0;
+  s->node_size = 0;
+}
+
+#undef cstack_item
+#undef cstack_next
+#undef cstack_tag
+#undef cstack_index
+#undef cstack_pack
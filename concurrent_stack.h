@@ -0,0 +1,51 @@
+/*
+ * @file: concurrent_stack.h
+ * @brief: Declares the lock-free stack, its per-thread node cache and their
+ * functions.
+ */
+
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum cstack_errors {
+  CSTACK_SUCCESS = 0,
+  CSTACK_ERR_NULL,
+  CSTACK_ERR_UNINIT,
+  CSTACK_ERR_ALLOC,
+  CSTACK_ERR_EMPTY
+};
+
+#define CSTACK_CACHE_LINE 64
+#define CSTACK_FIRST_CHUNK_SHIFT 6
+#define CSTACK_MAX_CHUNKS (33 - CSTACK_FIRST_CHUNK_SHIFT)
+#define CSTACK_LOCAL_NODES 64
+
+typedef struct cstack {
+  _Alignas(CSTACK_CACHE_LINE) _Atomic uint64_t top;
+  _Alignas(CSTACK_CACHE_LINE) _Atomic uint64_t free_top;
+  _Alignas(CSTACK_CACHE_LINE) _Atomic uint32_t fresh;
+  _Atomic(unsigned char *) chunks[CSTACK_MAX_CHUNKS];
+  size_t item_size;
+  size_t node_size;
+} cstack;
+
+typedef struct cstack_local {
+  uint32_t nodes[CSTACK_LOCAL_NODES];
+  size_t count;
+} cstack_local;
+
+char *cstack_get_error_string(enum cstack_errors error);
+int cstack_init(cstack *s, size_t item_size);
+int cstack_local_init(cstack_local *local);
+int cstack_push(cstack *s, cstack_local *local, void *item);
+int cstack_pop(cstack *s, cstack_local *local, void *item);
+int cstack_pop_all(cstack *s, cstack_local *local,
+                   void (*visit)(void *item, void *context), void *context);
+int cstack_local_flush(cstack *s, cstack_local *local);
+void cstack_free(cstack *s);
+
+#endif /* ifndef CONCURRENT_STACK_H */
@@ -0,0 +1,308 @@
+/*
+ * @file: concurrent_vector.c
+ * @brief: Implements an append-only vector that any number of threads can
+ * push to, and read from, at the same time without locks.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "concurrent_vector.h"
+
+char *cvec_get_error_string(enum cvec_errors error) {
+  switch (error) {
+  case CVEC_SUCCESS:
+    return "SUCCESS";
+  case CVEC_ERR_NULL:
+    return "NULL_PARAMETER";
+  case CVEC_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case CVEC_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case CVEC_ERR_INDEX:
+    return "INDEX_ERROR";
+  case CVEC_ERR_FULL:
+    return "VECTOR_FULL";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+/*
+ * Items live in buckets that double in size and never move: bucket k holds
+ * 2^(k + CVEC_FIRST_BUCKET_SHIFT) items, allocated by whichever writer first
+ * needs it. A push claims its indexes with one fetch-add on `reserved` and
+ * copies its items in, so writers never wait for each other and a pointer to
+ * a published item stays valid until cvec_free.
+ *
+ * Since writers finish in any order, every bucket also has a run length per
+ * item, set at the first index of each finished push to the number of items
+ * it wrote. Any writer can then move `published` over the runs that follow
+ * it, and the writer that finishes a push tries to, so `published` catches
+ * up as soon as the prefix before it is complete. The runs and `published`
+ * are accessed seq_cst: a writer stores its run and then reads `published`,
+ * while an advancing writer moves `published` and then reads the next run,
+ * and at least one of the two must see the other or the push would never be
+ * published.
+ *
+ * A push that fails after claiming its indexes still publishes them, so that
+ * pushes after it aren't held back forever. It writes no items, and its
+ * indexes read as zeros from the calloc'd bucket. A bucket that can't be
+ * allocated becomes CVEC_HOLE for good, and `published` steps over all of it;
+ * its indexes can't be read and every push that claims one fails.
+ */
+#define cvec_bucket_items(bucket)                                              \
+  ((size_t)1 << ((bucket) + CVEC_FIRST_BUCKET_SHIFT))
+#define CVEC_MAX_ITEMS                                                         \
+  (cvec_bucket_items(0) * (((size_t)1 << CVEC_MAX_BUCKETS) - 1))
+#define CVEC_MAX_RUN UINT32_MAX
+
+static unsigned char cvec_hole;
+#define CVEC_HOLE (&cvec_hole)
+
+int cvec_init(cvec *v, size_t item_size) {
+  if (!v)
+    return CVEC_ERR_NULL;
+  if (item_size == 0)
+    return CVEC_ERR_UNINIT;
+
+  atomic_init(&v->reserved, 0);
+  atomic_init(&v->published, 0);
+  for (size_t i = 0; i < CVEC_MAX_BUCKETS; i++)
+    atomic_init(&v->buckets[i], NULL);
+  v->item_size = item_size;
+  return CVEC_SUCCESS;
+}
+
+static size_t cvec_bucket_of(size_t index, size_t *offset) {
+  size_t position = index + cvec_bucket_items(0);
+  size_t bit = 63 - __builtin_clzll(position);
+  *offset = position - ((size_t)1 << bit);
+  return bit - CVEC_FIRST_BUCKET_SHIFT;
+}
+
+// The run lengths follow a bucket's items, aligned for uint32_t.
+static size_t cvec_runs_offset(cvec *v, size_t bucket) {
+  size_t align = _Alignof(_Atomic uint32_t);
+  return (cvec_bucket_items(bucket) * v->item_size + align - 1) & ~(align - 1);
+}
+
+static _Atomic uint32_t *cvec_run(cvec *v, unsigned char *base, size_t bucket,
+                                  size_t offset) {
+  return (_Atomic uint32_t *)(base + cvec_runs_offset(v, bucket)) + offset;
+}
+
+/*
+ * Returns bucket `bucket`, allocating it if no writer has yet, or CVEC_HOLE if
+ * it can't be. Several threads may race to allocate the same bucket; the
+ * loser frees its copy.
+ */
+static unsigned char *cvec_bucket(cvec *v, size_t bucket) {
+  unsigned char *base = atomic_load(&v->buckets[bucket]);
+  if (base != NULL)
+    return base;
+
+  size_t size = cvec_runs_offset(v, bucket) +
+                cvec_bucket_items(bucket) * sizeof(_Atomic uint32_t);
+  unsigned char *fresh = calloc(1, size);
+  if (fresh == NULL)
+    fresh = CVEC_HOLE;
+  if (atomic_compare_exchange_strong(&v->buckets[bucket], &base, fresh))
+    return fresh;
+  if (fresh != CVEC_HOLE)
+    free(fresh);
+  return base;
+}
+
+static void cvec_advance(cvec *v) {
+  size_t published = atomic_load(&v->published);
+  while (published < CVEC_MAX_ITEMS) {
+    size_t offset;
+    size_t bucket = cvec_bucket_of(published, &offset);
+    unsigned char *base = atomic_load(&v->buckets[bucket]);
+    if (base == NULL)
+      return;
+    size_t run = cvec_bucket_items(bucket) - offset;
+    if (base != CVEC_HOLE) {
+      run = atomic_load(cvec_run(v, base, bucket, offset));
+      if (run == 0)
+        return;
+    }
+    // On failure `published` is reloaded and the walk goes on from there.
+    if (atomic_compare_exchange_strong(&v->published, &published,
+                                       published + run))
+      published += run;
+  }
+}
+
+/*
+ * Appends `count` items from the contiguous array `items` at consecutive
+ * indexes and stores the first of them in `index` (which may be NULL). They
+ * become visible to readers once every earlier push has finished too. On
+ * CVEC_ERR_ALLOC or CVEC_ERR_FULL nothing is written, but the indexes it
+ * claimed are published all the same, reading as zeros.
+ */
+int cvec_push_batch(cvec *v, const void *items, size_t count, size_t *index) {
+  if (!v || (!items && count > 0))
+    return CVEC_ERR_NULL;
+  if (v->item_size == 0)
+    return CVEC_ERR_UNINIT;
+  if (count == 0)
+    return CVEC_SUCCESS;
+
+  int result = CVEC_SUCCESS;
+  size_t start =
+      atomic_fetch_add_explicit(&v->reserved, count, memory_order_relaxed);
+  size_t end = start + count;
+  if (start >= CVEC_MAX_ITEMS || count > CVEC_MAX_ITEMS - start) {
+    result = CVEC_ERR_FULL;
+    end = (start < CVEC_MAX_ITEMS) ? CVEC_MAX_ITEMS : start;
+  }
+
+  // Every bucket the push needs is allocated before any item is written, so
+  // that a failed push writes none.
+  for (size_t position = start; position < end;) {
+    size_t offset;
+    size_t bucket = cvec_bucket_of(position, &offset);
+    if (cvec_bucket(v, bucket) == CVEC_HOLE && result == CVEC_SUCCESS)
+      result = CVEC_ERR_ALLOC;
+    position += cvec_bucket_items(bucket) - offset;
+  }
+
+  const unsigned char *src = items;
+  for (size_t position = start; position < end;) {
+    size_t offset;
+    size_t bucket = cvec_bucket_of(position, &offset);
+    unsigned char *base = atomic_load(&v->buckets[bucket]);
+    size_t run = cvec_bucket_items(bucket) - offset;
+    if (run > end - position)
+      run = end - position;
+    if (run > CVEC_MAX_RUN)
+      run = CVEC_MAX_RUN;
+    if (base != CVEC_HOLE) {
+      if (result == CVEC_SUCCESS)
+        memcpy(base + offset * v->item_size, src, run * v->item_size);
+      atomic_store(cvec_run(v, base, bucket, offset), (uint32_t)run);
+    }
+    src += run * v->item_size;
+    position += run;
+  }
+
+  cvec_advance(v);
+  if (index && result == CVEC_SUCCESS)
+    *index = start;
+  return result;
+}
+
+/*
+ * Gives a thread a buffer for `batch` items, so that its pushes claim indexes
+ * `batch` at a time instead of contending on `reserved` for every item.
+ */
+int cvec_local_init(cvec *v, cvec_local *local, size_t batch) {
+  if (!v || !local)
+    return CVEC_ERR_NULL;
+  if (v->item_size == 0 || batch == 0)
+    return CVEC_ERR_UNINIT;
+
+  local->items = malloc(batch * v->item_size);
+  if (local->items == NULL)
+    return CVEC_ERR_ALLOC;
+  local->count = 0;
+  local->capacity = batch;
+  return CVEC_SUCCESS;
+}
+
+/*
+ * `local` is the calling thread's batch buffer and may be NULL, in which case
+ * the item is appended straight away. Otherwise it waits in the buffer until
+ * the buffer fills or is flushed.
+ */
+int cvec_push(cvec *v, cvec_local *local, const void *item) {
+  if (!v || !item)
+    return CVEC_ERR_NULL;
+  if (local == NULL)
+    return cvec_push_batch(v, item, 1, NULL);
+  if (local->items == NULL)
+    return CVEC_ERR_UNINIT;
+
+  memcpy(local->items + local->count * v->item_size, item, v->item_size);
+  local->count++;
+  if (local->count == local->capacity)
+    return cvec_local_flush(v, local);
+  return CVEC_SUCCESS;
+}
+
+int cvec_local_flush(cvec *v, cvec_local *local) {
+  if (!v || !local)
+    return CVEC_ERR_NULL;
+
+  int result = cvec_push_batch(v, local->items, local->count, NULL);
+  local->count = 0;
+  return result;
+}
+
+// Drops anything still buffered; flush first to keep it.
+void cvec_local_free(cvec_local *local) {
+  if (!local)
+    return;
+  free(local->items);
+  local->items = NULL;
+  local->count = 0;
+  local->capacity = 0;
+}
+
+// Items below the returned index are all written and may be read.
+size_t cvec_published(cvec *v) {
+  if (!v)
+    return 0;
+  return atomic_load_explicit(&v->published, memory_order_acquire);
+}
+
+void *cvec_get_ptr(cvec *v, size_t index) {
+  if (!v || index >= cvec_published(v))
+    return NULL;
+
+  size_t offset;
+  size_t bucket = cvec_bucket_of(index, &offset);
+  unsigned char *base =
+      atomic_load_explicit(&v->buckets[bucket], memory_order_acquire);
+  if (base == CVEC_HOLE)
+    return NULL;
+  return base + offset * v->item_size;
+}
+
+int cvec_get(cvec *v, size_t index, void *item) {
+  if (!v || !item)
+    return CVEC_ERR_NULL;
+  if (v->item_size == 0)
+    return CVEC_ERR_UNINIT;
+
+  void *src = cvec_get_ptr(v, index);
+  if (src == NULL)
+    return CVEC_ERR_INDEX;
+  memcpy(item, src, v->item_size);
+  return CVEC_SUCCESS;
+}
+
+// Not thread-safe: every other thread must be done with the vector.
+void cvec_free(cvec *v) {
+  if (!v)
+    return;
+
+  for (size_t i = 0; i < CVEC_MAX_BUCKETS; i++) {
+    unsigned char *base = atomic_load(&v->buckets[i]);
+    if (base != CVEC_HOLE)
+      free(base);
+    atomic_store(&v->buckets[i], NULL);
+  }
+  atomic_store(&v->reserved, 0);
+  atomic_store(&v->published, 0);
+  v->item_size = 0;
+}
+
+#undef CVEC_HOLE
+#undef CVEC_MAX_RUN
+#undef CVEC_MAX_ITEMS
+#undef cvec_bucket_items
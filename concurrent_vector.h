@@ -0,0 +1,63 @@
+/*
+ * @file: concurrent_vector.h
+ * @brief: Declares the append-only concurrent vector, its per-thread batch
+ * buffer and their functions.
+ */
+
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum cvec_errors {
+  CVEC_SUCCESS = 0,
+  CVEC_ERR_NULL,
+  CVEC_ERR_UNINIT,
+  CVEC_ERR_ALLOC,
+  CVEC_ERR_INDEX,
+  CVEC_ERR_FULL
+};
+
+#define CVEC_CACHE_LINE 64
+#define CVEC_FIRST_BUCKET_SHIFT 6
+#define CVEC_MAX_BUCKETS 42
+
+/*
+ * `reserved` is the next index a writer can claim and `published` the length
+ * of the prefix whose pushes have all finished, failed ones included; readers
+ * may read any index below `published` while writers keep appending. Each hot
+ * counter sits on its own cache line.
+ */
+typedef struct cvec {
+  _Alignas(CVEC_CACHE_LINE) _Atomic size_t reserved;
+  _Alignas(CVEC_CACHE_LINE) _Atomic size_t published;
+  _Alignas(CVEC_CACHE_LINE) _Atomic(unsigned char *) buckets[CVEC_MAX_BUCKETS];
+  size_t item_size;
+} cvec;
+
+/*
+ * A thread's batch buffer: pushes collect here and are appended to the vector
+ * together, with a single claim on `reserved`, once `capacity` of them are
+ * waiting or on cvec_local_flush.
+ */
+typedef struct cvec_local {
+  unsigned char *items;
+  size_t count;
+  size_t capacity;
+} cvec_local;
+
+char *cvec_get_error_string(enum cvec_errors error);
+int cvec_init(cvec *v, size_t item_size);
+int cvec_local_init(cvec *v, cvec_local *local, size_t batch);
+int cvec_push_batch(cvec *v, const void *items, size_t count, size_t *index);
+int cvec_push(cvec *v, cvec_local *local, const void *item);
+int cvec_local_flush(cvec *v, cvec_local *local);
+void cvec_local_free(cvec_local *local);
+size_t cvec_published(cvec *v);
+void *cvec_get_ptr(cvec *v, size_t index);
+int cvec_get(cvec *v, size_t index, void *item);
+void cvec_free(cvec *v);
+
+#endif /* ifndef CONCURRENT_VECTOR_H */
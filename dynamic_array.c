@@ -4,20 +4,20 @@
  * it.
  */
 
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-enum da_errors {
-  DA_SUCCESS = 0,
-  DA_ERR_NULL,
-  DA_ERR_INDEX,
-  DA_ERR_UNINIT,
-  DA_ERR_ALLOC,
-  DA_ERR_RESIZE,
-  DA_ERR_EMPTY
-};
+#include "dynamic_array.h"
 
-char *sll_get_error_string(enum da_errors error) {
+char *da_get_error_string(enum da_errors error) {
   switch (error) {
   case DA_SUCCESS:
     return "SUCCESS";
@@ -33,25 +33,28 @@ char *sll_get_error_string(enum da_errors error) {
     return "RESIZE_ERROR";
   case DA_ERR_EMPTY:
     return "STACK_EMPTY";
+  case DA_ERR_IO:
+    return "IO_ERROR";
+  case DA_ERR_READONLY:
+    return "READ_ONLY";
+  case DA_ERR_FORMAT:
+    return "FORMAT_ERROR";
   default:
     return "UNKNOWN_ERROR";
   }
 }
 
-typedef struct dynamic_array {
-  void *items;
-  size_t item_size;
-  size_t count;
-  size_t capacity;
-} dynamic_array;
-
 #define DA_INITIAL_CAPACITY 4
 #define DA_RESIZE_FACTOR 2
+// Shrink only once the array is a quarter full, so removing an item right
+// after an expand doesn't give the memory straight back.
+#define DA_SHRINK_THRESHOLD 4
 
 int da_init(dynamic_array *da, size_t size) {
   if (!da)
     return DA_ERR_NULL;
   da->item_size = size;
+  da->mapping = NULL;
   da->capacity = DA_INITIAL_CAPACITY;
   da->items = malloc(da->item_size * da->capacity);
   if (!da->items) {
@@ -59,18 +62,384 @@ int da_init(dynamic_array *da, size_t size) {
     return DA_ERR_ALLOC;
   }
   da->count = 0;
+  telemetry_clear(da);
+  telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, allocations, 1);
+  telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, bytes_allocated,
+                da->item_size * da->capacity);
+  telemetry_peak(da, TELEMETRY_DYNAMIC_ARRAY, peak_capacity, da->capacity);
+  return DA_SUCCESS;
+}
+
+/*
+ * A dynamic array can also live in a file: a da_file_header followed directly
+ * by the items, mapped with mmap. Reopening the file maps it again as is, so
+ * starting up costs nothing however large the array is. Only da_checkpoint
+ * (and da_free) bring the header's count and checksum up to date, so after a
+ * crash the file reads back with the count of the last checkpoint. The file is
+ * in native byte order, and several processes can map it read-only at once,
+ * sharing one copy in the page cache, as long as none of them writes to it.
+ */
+#define DA_FILE_MAGIC 0x5941525241415344ULL // "DSAARRAY"
+#define DA_FILE_VERSION 1
+#define DA_FILE_HEADER_SIZE 64
+
+typedef struct da_file_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t item_size;
+  uint64_t count;
+  uint64_t capacity;
+  uint64_t checksum;
+} da_file_header;
+
+/*
+ * How a mapped array's items are held: from a file (fd >= 0), or for arrays
+ * made with da_init_large, anonymous huge-page memory from large_alloc
+ * (fd == -1). map_size is the size of the whole mapping in bytes.
+ */
+struct da_mapping {
+  int fd;
+  int read_only;
+  size_t map_size;
+  enum large_numa_policy numa;
+  unsigned int threads;
+};
+
+#define da_file_base(da) ((char *)(da)->items - DA_FILE_HEADER_SIZE)
+#define da_file_header_of(da) ((da_file_header *)da_file_base(da))
+#define da_read_only(da) ((da)->mapping != NULL && (da)->mapping->read_only)
+#define da_file_backed(da) ((da)->mapping != NULL && (da)->mapping->fd >= 0)
+
+static uint64_t da_checksum(const unsigned char *bytes, size_t size) {
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ size;
+  while (size >= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, 8);
+    h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+    bytes += 8;
+    size -= 8;
+  }
+  while (size > 0) {
+    h = (h ^ *bytes++) * 0xFF51AFD7ED558CCDULL;
+    size--;
+  }
+  return h ^ (h >> 29);
+}
+
+/*
+ * Maps the array stored at `path` into `da`. In DA_FILE_READ_WRITE mode a
+ * missing or empty file is created with room for a few items of `item_size`;
+ * otherwise `item_size` must match the file's, or be 0 to take it from the
+ * file. Any other da_* function then works on the mapping, except that a
+ * DA_FILE_READ_ONLY array refuses changes with DA_ERR_READONLY.
+ */
+int da_map_file(dynamic_array *da, const char *path, size_t item_size,
+                enum da_file_mode mode) {
+  if (!da || !path)
+    return DA_ERR_NULL;
+
+  // A file this call creates is removed again if mapping it fails.
+  int read_only = (mode == DA_FILE_READ_ONLY);
+  int created = 0;
+  int fd = open(path, read_only ? O_RDONLY : O_RDWR);
+  if (fd < 0 && errno == ENOENT && !read_only) {
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    created = (fd >= 0);
+    if (fd < 0 && errno == EEXIST)
+      fd = open(path, O_RDWR);
+  }
+  if (fd < 0)
+    return DA_ERR_IO;
+
+  int result = DA_ERR_IO;
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    goto fail_close;
+
+  size_t size = (size_t)st.st_size;
+  int fresh = (size == 0 && !read_only);
+  if (fresh) {
+    result = DA_ERR_UNINIT;
+    if (item_size == 0)
+      goto fail_close;
+    result = DA_ERR_IO;
+    size = DA_FILE_HEADER_SIZE + DA_INITIAL_CAPACITY * item_size;
+    if (ftruncate(fd, (off_t)size) != 0)
+      goto fail_close;
+  }
+
+  result = DA_ERR_FORMAT;
+  if (size < DA_FILE_HEADER_SIZE)
+    goto fail_close;
+
+  result = DA_ERR_IO;
+  char *base = mmap(NULL, size, read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+    goto fail_close;
+
+  da_file_header *header = (da_file_header *)base;
+  if (fresh) {
+    header->magic = DA_FILE_MAGIC;
+    header->version = DA_FILE_VERSION;
+    header->header_size = DA_FILE_HEADER_SIZE;
+    header->item_size = item_size;
+    header->count = 0;
+    header->capacity = DA_INITIAL_CAPACITY;
+    header->checksum = da_checksum(NULL, 0);
+  }
+
+  // A crash while growing can leave the file longer than the header says;
+  // the extra space just becomes capacity.
+  result = DA_ERR_FORMAT;
+  if (header->magic != DA_FILE_MAGIC || header->version != DA_FILE_VERSION ||
+      header->header_size != DA_FILE_HEADER_SIZE || header->item_size == 0 ||
+      (item_size != 0 && header->item_size != item_size))
+    goto fail_unmap;
+  size_t capacity = (size - DA_FILE_HEADER_SIZE) / header->item_size;
+  if (header->count > header->capacity || header->capacity > capacity)
+    goto fail_unmap;
+
+  result = DA_ERR_ALLOC;
+  struct da_mapping *file = malloc(sizeof(struct da_mapping));
+  if (file == NULL)
+    goto fail_unmap;
+  file->fd = fd;
+  file->read_only = read_only;
+  file->map_size = size;
+  file->numa = LARGE_NUMA_DEFAULT;
+  file->threads = 0;
+
+  if (!read_only)
+    header->capacity = capacity;
+  da->items = base + DA_FILE_HEADER_SIZE;
+  da->item_size = header->item_size;
+  da->count = header->count;
+  da->capacity = capacity;
+  da->mapping = file;
+  telemetry_clear(da);
+  return DA_SUCCESS;
+
+fail_unmap:
+  munmap(base, size);
+fail_close:
+  close(fd);
+  if (created)
+    unlink(path);
+  return result;
+}
+
+/*
+ * Resizes the file and its mapping to `capacity` items. The file grows before
+ * the mapping and shrinks after it, and the header's capacity never exceeds
+ * what the file holds. It never shrinks below the count of the last
+ * checkpoint, whose items must still be there if the process crashes.
+ */
+static int da_file_resize(dynamic_array *da, size_t capacity) {
+  struct da_mapping *file = da->mapping;
+  if (capacity < da_file_header_of(da)->count)
+    capacity = da_file_header_of(da)->count;
+  if (capacity == da->capacity)
+    return DA_SUCCESS;
+  size_t size = DA_FILE_HEADER_SIZE + capacity * da->item_size;
+  int grow = capacity > da->capacity;
+
+  if (grow && ftruncate(file->fd, (off_t)size) != 0)
+    return DA_ERR_IO;
+  if (!grow)
+    da_file_header_of(da)->capacity = capacity;
+
+#ifdef MREMAP_MAYMOVE
+  char *base = mremap(da_file_base(da), file->map_size, size, MREMAP_MAYMOVE);
+  if (base == MAP_FAILED)
+    return DA_ERR_ALLOC;
+#else
+  char *base =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+  if (base == MAP_FAILED)
+    return DA_ERR_ALLOC;
+  munmap(da_file_base(da), file->map_size);
+#endif
+
+  file->map_size = size;
+  da->items = base + DA_FILE_HEADER_SIZE;
+  da->capacity = capacity;
+  if (grow) {
+    da_file_header_of(da)->capacity = capacity;
+    telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, grows, size, 0, capacity);
+  } else {
+    telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, shrinks, size, 0, capacity);
+    if (ftruncate(file->fd, (off_t)size) != 0)
+      return DA_ERR_IO;
+  }
+  return DA_SUCCESS;
+}
+
+/*
+ * Writes the count and a checksum of the items to the header and flushes the
+ * whole mapping to disk, items before header, so that the file holds a
+ * consistent array once this returns.
+ */
+int da_checkpoint(dynamic_array *da) {
+  if (!da)
+    return DA_ERR_NULL;
+  if (!da_file_backed(da))
+    return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
+
+  char *base = da_file_base(da);
+  if (msync(base, da->mapping->map_size, MS_SYNC) != 0)
+    return DA_ERR_IO;
+
+  da_file_header *header = da_file_header_of(da);
+  header->count = da->count;
+  header->capacity = da->capacity;
+  header->checksum = da_checksum(da->items, da->count * da->item_size);
+  if (msync(base, DA_FILE_HEADER_SIZE, MS_SYNC) != 0)
+    return DA_ERR_IO;
+  return DA_SUCCESS;
+}
+
+/*
+ * Checks the items against the checksum of the last checkpoint. This reads
+ * the whole array, so it is left to the caller rather than done on every
+ * open, and is only meaningful before the array is changed again.
+ */
+int da_verify(dynamic_array *da) {
+  if (!da)
+    return DA_ERR_NULL;
+  if (!da_file_backed(da))
+    return DA_ERR_UNINIT;
+
+  da_file_header *header = da_file_header_of(da);
+  if (header->count > da->capacity ||
+      da_checksum(da->items, header->count * da->item_size) != header->checksum)
+    return DA_ERR_FORMAT;
+  return DA_SUCCESS;
+}
+
+/*
+ * Like da_init, but for arrays of gigabytes: the items live in memory from
+ * large_alloc, aligned to 2MB and advised to use huge pages so that walking
+ * the array doesn't miss the TLB on every few pages, and placed on NUMA nodes
+ * by `numa` with `threads` first-touch threads. The array grows by whole huge
+ * pages with mremap, so its pages are never copied.
+ */
+int da_init_large(dynamic_array *da, size_t size, size_t capacity,
+                  enum large_numa_policy numa, unsigned int threads) {
+  if (!da)
+    return DA_ERR_NULL;
+  if (size == 0)
+    return DA_ERR_UNINIT;
+  if (capacity > (SIZE_MAX - LARGE_PAGE_SIZE) / size)
+    return DA_ERR_ALLOC;
+
+  struct da_mapping *mapping = malloc(sizeof(struct da_mapping));
+  if (mapping == NULL)
+    return DA_ERR_ALLOC;
+  if (capacity < DA_INITIAL_CAPACITY)
+    capacity = DA_INITIAL_CAPACITY;
+  size_t bytes = large_round(capacity * size);
+  da->items = large_alloc(bytes, numa, threads);
+  if (da->items == NULL) {
+    free(mapping);
+    da->capacity = 0;
+    return DA_ERR_ALLOC;
+  }
+
+  mapping->fd = -1;
+  mapping->read_only = 0;
+  mapping->map_size = bytes;
+  mapping->numa = numa;
+  mapping->threads = threads;
+  da->mapping = mapping;
+  da->item_size = size;
+  da->count = 0;
+  da->capacity = bytes / size;
+  telemetry_clear(da);
+  telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, allocations, 1);
+  telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, bytes_allocated, bytes);
+  telemetry_peak(da, TELEMETRY_DYNAMIC_ARRAY, peak_capacity, da->capacity);
+  return DA_SUCCESS;
+}
+
+// Rounding to huge pages can make a shrink a no-op, which is fine.
+static int da_large_resize(dynamic_array *da, size_t capacity) {
+  struct da_mapping *mapping = da->mapping;
+  size_t bytes = large_round(capacity * da->item_size);
+  if (bytes == mapping->map_size)
+    return DA_SUCCESS;
+
+  void *items = large_realloc(da->items, mapping->map_size, bytes,
+                              mapping->numa, mapping->threads);
+  if (items == NULL)
+    return DA_ERR_ALLOC;
+  int grow = bytes > mapping->map_size;
+  mapping->map_size = bytes;
+  da->items = items;
+  da->capacity = bytes / da->item_size;
+  if (grow)
+    telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, grows, bytes, 0,
+                     da->capacity);
+  else
+    telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, shrinks, bytes, 0,
+                     da->capacity);
+  return DA_SUCCESS;
+}
+
+/*
+ * Stores in `pages` how many 2MB huge pages back the items, as the kernel
+ * reports in /proc/self/smaps. Transparent huge pages are only a request, so
+ * this is the way to see whether da_init_large actually got them.
+ */
+int da_huge_pages(dynamic_array *da, size_t *pages) {
+  if (!da || !pages)
+    return DA_ERR_NULL;
+  if (!da->items)
+    return DA_ERR_UNINIT;
+
+  size_t bytes = (da->mapping != NULL) ? da->mapping->map_size
+                                       : da->capacity * da->item_size;
+  if (large_huge_pages(da->items, bytes, pages) != LARGE_SUCCESS)
+    return DA_ERR_IO;
   return DA_SUCCESS;
 }
 
+static void da_unmap(dynamic_array *da) {
+  struct da_mapping *mapping = da->mapping;
+  if (mapping->fd < 0) {
+    large_free(da->items, mapping->map_size);
+  } else {
+    if (!mapping->read_only)
+      da_checkpoint(da);
+    munmap(da_file_base(da), mapping->map_size);
+    close(mapping->fd);
+  }
+  free(mapping);
+  da->mapping = NULL;
+}
+
 int da_expand(dynamic_array *da) {
   if (!da)
     return DA_ERR_NULL;
   if (!da->items)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
   size_t new_capacity = da->capacity * DA_RESIZE_FACTOR;
+  if (da->mapping)
+    return da_file_backed(da) ? da_file_resize(da, new_capacity)
+                              : da_large_resize(da, new_capacity);
   void *new_items = realloc(da->items, da->item_size * new_capacity);
   if (!new_items)
     return DA_ERR_ALLOC;
+  telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, grows,
+                   da->item_size * new_capacity,
+                   (new_items != da->items) ? da->item_size * da->capacity : 0,
+                   new_capacity);
   da->items = new_items;
   da->capacity = new_capacity;
   return DA_SUCCESS;
@@ -81,13 +450,22 @@ int da_shrink(dynamic_array *da) {
     return DA_ERR_NULL;
   if (!da->items)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
   size_t new_capacity = da->capacity / DA_RESIZE_FACTOR;
   if (new_capacity < DA_INITIAL_CAPACITY) {
     new_capacity = DA_INITIAL_CAPACITY;
   }
+  if (da->mapping)
+    return da_file_backed(da) ? da_file_resize(da, new_capacity)
+                              : da_large_resize(da, new_capacity);
   void *new_items = realloc(da->items, new_capacity * da->item_size);
   if (new_items == NULL)
     return DA_ERR_ALLOC;
+  telemetry_resize(da, TELEMETRY_DYNAMIC_ARRAY, shrinks,
+                   new_capacity * da->item_size,
+                   (new_items != da->items) ? new_capacity * da->item_size : 0,
+                   new_capacity);
   da->items = new_items;
   da->capacity = new_capacity;
   return DA_SUCCESS;
@@ -113,6 +491,8 @@ int da_set_item(dynamic_array *da, size_t index, void *item) {
     return DA_ERR_INDEX;
   if (!da->items)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
 
   void *dest = (char *)da->items + (index * da->item_size);
   memcpy(dest, item, da->item_size);
@@ -124,6 +504,8 @@ int da_push(dynamic_array *da, void *item) {
     return DA_ERR_NULL;
   if (!da->items || da->item_size == 0)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
 
   if (da->count == da->capacity)
     if (da_expand(da) != 0)
@@ -141,6 +523,8 @@ int da_insert_item(dynamic_array *da, size_t index, void *item) {
     return DA_ERR_INDEX;
   if (!da->items || da->item_size == 0)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
 
   if (da->count == da->capacity) {
     if (da_expand(da) != DA_SUCCESS)
@@ -150,6 +534,8 @@ int da_insert_item(dynamic_array *da, size_t index, void *item) {
   memmove((char *)da->items + ((index + 1) * da->item_size),
           (char *)da->items + (index * da->item_size),
           (da->count - index) * da->item_size);
+  telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, memmove_bytes,
+                (da->count - index) * da->item_size);
   memcpy((char *)da->items + (index * da->item_size), item, da->item_size);
   da->count++;
   return DA_SUCCESS;
@@ -162,16 +548,20 @@ int da_remove_item(dynamic_array *da, size_t index) {
     return DA_ERR_INDEX;
   if (!da->items || da->item_size == 0)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
 
   if (index != da->count - 1) {
     memmove((char *)da->items + (index * da->item_size),
             (char *)da->items + (index * da->item_size) + da->item_size,
             (da->count - index - 1) * da->item_size);
+    telemetry_add(da, TELEMETRY_DYNAMIC_ARRAY, memmove_bytes,
+                  (da->count - index - 1) * da->item_size);
   }
 
   da->count--;
 
-  if (da->count < (da->capacity / DA_RESIZE_FACTOR))
+  if (da->count < (da->capacity / DA_SHRINK_THRESHOLD))
     if (da_shrink(da) != 0)
       return DA_ERR_RESIZE;
 
@@ -183,6 +573,8 @@ int da_pop_item(dynamic_array *da, void *item) {
     return DA_ERR_NULL;
   if (!da->items || da->item_size == 0)
     return DA_ERR_UNINIT;
+  if (da_read_only(da))
+    return DA_ERR_READONLY;
   if (da->count == 0)
     return DA_ERR_EMPTY;
 
@@ -192,7 +584,7 @@ int da_pop_item(dynamic_array *da, void *item) {
 
   da->count--;
 
-  if (da->count < (da->capacity / DA_RESIZE_FACTOR))
+  if (da->count < (da->capacity / DA_SHRINK_THRESHOLD))
     if (da_shrink(da) != 0)
       return DA_ERR_RESIZE;
 
@@ -202,12 +594,165 @@ int da_pop_item(dynamic_array *da, void *item) {
 void da_free(dynamic_array *da) {
   if (!da)
     return;
-  free(da->items);
+  if (da->mapping)
+    da_unmap(da);
+  else
+    free(da->items);
   da->items = NULL;
   da->count = 0;
   da->capacity = 0;
   da->item_size = 0;
 }
 
+/*
+ * Copies the counters `da` has kept since da_init or the last
+ * da_stats_reset into `stats`. They read as zero unless the library was built
+ * with DSA_TELEMETRY.
+ */
+int da_stats_snapshot(dynamic_array *da, telemetry_stats *stats) {
+  if (!da || !stats)
+    return DA_ERR_NULL;
+  telemetry_copy(da, stats);
+  return DA_SUCCESS;
+}
+
+int da_stats_reset(dynamic_array *da) {
+  if (!da)
+    return DA_ERR_NULL;
+  telemetry_clear(da);
+  return DA_SUCCESS;
+}
+
+/*
+ * A segmented array stores its items in segments that double in size and are
+ * never moved: segment k holds DA_FIRST_SEGMENT << k items. Growing means
+ * allocating one more segment instead of realloc'ing and copying everything,
+ * so a push never costs more than one allocation and pointers returned by
+ * sa_get_ptr stay valid until that item is popped. One empty segment is kept
+ * around after popping past it, so pushing and popping across a segment
+ * boundary doesn't allocate every time.
+ */
+#define DA_FIRST_SEGMENT_SHIFT 4
+#define DA_FIRST_SEGMENT ((size_t)1 << DA_FIRST_SEGMENT_SHIFT)
+// Number of items the first `segments` segments hold together.
+#define sa_capacity(segments)                                                  \
+  (DA_FIRST_SEGMENT * (((size_t)1 << (segments)) - 1))
+
+static void *sa_item(segmented_array *sa, size_t index) {
+  size_t position = index + DA_FIRST_SEGMENT;
+  size_t bit = 63 - __builtin_clzll(position);
+  size_t offset = position - ((size_t)1 << bit);
+  return (char *)sa->segments[bit - DA_FIRST_SEGMENT_SHIFT] +
+         (offset * sa->item_size);
+}
+
+int sa_init(segmented_array *sa, size_t size) {
+  if (!sa)
+    return DA_ERR_NULL;
+  for (size_t i = 0; i < DA_MAX_SEGMENTS; i++)
+    sa->segments[i] = NULL;
+  sa->item_size = size;
+  sa->count = 0;
+  sa->segment_count = 0;
+  return DA_SUCCESS;
+}
+
+void *sa_get_ptr(segmented_array *sa, size_t index) {
+  if (!sa || index >= sa->count)
+    return NULL;
+  return sa_item(sa, index);
+}
+
+int sa_get_item(segmented_array *sa, size_t index, void *item) {
+  if (!sa || !item)
+    return DA_ERR_NULL;
+  if (index >= sa->count)
+    return DA_ERR_INDEX;
+  if (sa->item_size == 0)
+    return DA_ERR_UNINIT;
+
+  memcpy(item, sa_item(sa, index), sa->item_size);
+  return DA_SUCCESS;
+}
+
+int sa_set_item(segmented_array *sa, size_t index, void *item) {
+  if (!sa || !item)
+    return DA_ERR_NULL;
+  if (index >= sa->count)
+    return DA_ERR_INDEX;
+  if (sa->item_size == 0)
+    return DA_ERR_UNINIT;
+
+  memcpy(sa_item(sa, index), item, sa->item_size);
+  return DA_SUCCESS;
+}
+
+int sa_push(segmented_array *sa, void *item) {
+  if (!sa || !item)
+    return DA_ERR_NULL;
+  if (sa->item_size == 0)
+    return DA_ERR_UNINIT;
+
+  if (sa->count == sa_capacity(sa->segment_count)) {
+    if (sa->segment_count == DA_MAX_SEGMENTS)
+      return DA_ERR_RESIZE;
+    size_t items = DA_FIRST_SEGMENT << sa->segment_count;
+    void *segment = malloc(items * sa->item_size);
+    if (!segment)
+      return DA_ERR_ALLOC;
+    sa->segments[sa->segment_count++] = segment;
+  }
+
+  memcpy(sa_item(sa, sa->count), item, sa->item_size);
+  sa->count++;
+  return DA_SUCCESS;
+}
+
+// `item` may be NULL to just drop the last item.
+int sa_pop_item(segmented_array *sa, void *item) {
+  if (!sa)
+    return DA_ERR_NULL;
+  if (sa->item_size == 0)
+    return DA_ERR_UNINIT;
+  if (sa->count == 0)
+    return DA_ERR_EMPTY;
+
+  sa->count--;
+  if (item)
+    memcpy(item, sa_item(sa, sa->count), sa->item_size);
+
+  if (sa->segment_count >= 2 &&
+      sa->count <= sa_capacity(sa->segment_count - 2)) {
+    sa->segment_count--;
+    free(sa->segments[sa->segment_count]);
+    sa->segments[sa->segment_count] = NULL;
+  }
+
+  return DA_SUCCESS;
+}
+
+void sa_free(segmented_array *sa) {
+  if (!sa)
+    return;
+  for (size_t i = 0; i < sa->segment_count; i++) {
+    free(sa->segments[i]);
+    sa->segments[i] = NULL;
+  }
+  sa->count = 0;
+  sa->segment_count = 0;
+  sa->item_size = 0;
+}
+
+#undef sa_capacity
+#undef da_file_backed
+#undef da_read_only
+#undef da_file_header_of
+#undef da_file_base
+#undef DA_FILE_HEADER_SIZE
+#undef DA_FILE_VERSION
+#undef DA_FILE_MAGIC
+#undef DA_FIRST_SEGMENT
+#undef DA_FIRST_SEGMENT_SHIFT
+#undef DA_SHRINK_THRESHOLD
 #undef DA_INITIAL_CAPACITY
 #undef DA_RESIZE_FACTOR
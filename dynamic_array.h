@@ -0,0 +1,80 @@
+/*
+ * @file: dynamic_array.h
+ * @brief: Declares the dynamic array and segmented array types and their
+ * functions.
+ */
+
+#ifndef DYNAMIC_ARRAY_H
+#define DYNAMIC_ARRAY_H
+
+#include <stddef.h>
+
+#include "large_alloc.h"
+#include "telemetry.h"
+
+enum da_errors {
+  DA_SUCCESS = 0,
+  DA_ERR_NULL,
+  DA_ERR_INDEX,
+  DA_ERR_UNINIT,
+  DA_ERR_ALLOC,
+  DA_ERR_RESIZE,
+  DA_ERR_EMPTY,
+  DA_ERR_IO,
+  DA_ERR_READONLY,
+  DA_ERR_FORMAT
+};
+
+enum da_file_mode { DA_FILE_READ_WRITE = 0, DA_FILE_READ_ONLY };
+
+struct da_mapping;
+
+typedef struct dynamic_array {
+  void *items;
+  size_t item_size;
+  size_t count;
+  size_t capacity;
+  struct da_mapping *mapping; // NULL unless from da_map_file or da_init_large
+#ifdef DSA_TELEMETRY
+  telemetry_stats stats;
+#endif
+} dynamic_array;
+
+#define DA_MAX_SEGMENTS 48
+
+typedef struct segmented_array {
+  void *segments[DA_MAX_SEGMENTS];
+  size_t item_size;
+  size_t count;
+  size_t segment_count;
+} segmented_array;
+
+char *da_get_error_string(enum da_errors error);
+int da_init(dynamic_array *da, size_t size);
+int da_init_large(dynamic_array *da, size_t size, size_t capacity,
+                  enum large_numa_policy numa, unsigned int threads);
+int da_map_file(dynamic_array *da, const char *path, size_t item_size,
+                enum da_file_mode mode);
+int da_checkpoint(dynamic_array *da);
+int da_verify(dynamic_array *da);
+int da_huge_pages(dynamic_array *da, size_t *pages);
+int da_expand(dynamic_array *da);
+int da_shrink(dynamic_array *da);
+int da_get_item(dynamic_array *da, size_t index, void *item);
+int da_set_item(dynamic_array *da, size_t index, void *item);
+int da_push(dynamic_array *da, void *item);
+int da_insert_item(dynamic_array *da, size_t index, void *item);
+int da_remove_item(dynamic_array *da, size_t index);
+int da_pop_item(dynamic_array *da, void *item);
+void da_free(dynamic_array *da);
+int da_stats_snapshot(dynamic_array *da, telemetry_stats *stats);
+int da_stats_reset(dynamic_array *da);
+int sa_init(segmented_array *sa, size_t size);
+void *sa_get_ptr(segmented_array *sa, size_t index);
+int sa_get_item(segmented_array *sa, size_t index, void *item);
+int sa_set_item(segmented_array *sa, size_t index, void *item);
+int sa_push(segmented_array *sa, void *item);
+int sa_pop_item(segmented_array *sa, void *item);
+void sa_free(segmented_array *sa);
+
+#endif /* ifndef DYNAMIC_ARRAY_H */
@@ -0,0 +1,275 @@
+/*
+ * @file: hash_map.c
+ * @brief: Implements an open-addressing hash map in the style of a Swiss
+ * table: one control byte per slot, probed 16 at a time, with keys and values
+ * of any fixed size kept in flat arrays.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_map.h"
+
+char *hm_get_error_string(enum hm_errors error) {
+  switch (error) {
+  case HM_SUCCESS:
+    return "SUCCESS";
+  case HM_ERR_NULL:
+    return "NULL_PARAMETER";
+  case HM_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case HM_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case HM_ERR_NOT_FOUND:
+    return "KEY_NOT_FOUND";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+// The map grows once it would be more than 7/8 full.
+#define HM_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+static uint64_t hm_default_hash(const void *key, size_t size) {
+  const unsigned char *bytes = key;
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ (size * 0xFF51AFD7ED558CCDULL);
+
+  while (size >= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, 8);
+    h = (h ^ word) * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 29;
+    bytes += 8;
+    size -= 8;
+  }
+  if (size > 0) {
+    uint64_t word = 0;
+    memcpy(&word, bytes, size);
+    h = (h ^ word) * 0xC2B2AE3D27D4EB4FULL;
+  }
+
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static int hm_default_equal(const void *a, const void *b, size_t size) {
+  return memcmp(a, b, size) == 0;
+}
+
+// Empty and deleted are the only negative control bytes.
+static inline uint32_t hm_group_match_free(const int8_t *group) {
+#ifdef __SSE2__
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (uint32_t)_mm_movemask_epi8(ctrl);
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < HM_GROUP_WIDTH; i++)
+    mask |= (uint32_t)(group[i] < 0) << i;
+  return mask;
+#endif
+}
+
+static inline void hm_set_ctrl(hash_map *map, size_t slot, int8_t byte) {
+  map->ctrl[slot] = byte;
+  if (slot < HM_GROUP_WIDTH)
+    map->ctrl[map->capacity + slot] = byte;
+}
+
+int hm_init(hash_map *map, size_t key_size, size_t value_size, hm_hash_fn hash,
+            hm_equal_fn equal) {
+  if (!map)
+    return HM_ERR_NULL;
+  if (key_size == 0)
+    return HM_ERR_UNINIT;
+
+  map->ctrl = NULL;
+  map->keys = NULL;
+  map->values = NULL;
+  map->key_size = key_size;
+  map->value_size = value_size;
+  map->count = 0;
+  map->capacity = 0;
+  map->growth_left = 0;
+  map->hash = hash ? hash : hm_default_hash;
+  map->equal = equal ? equal : hm_default_equal;
+  return HM_SUCCESS;
+}
+
+// First empty or deleted slot on the probe sequence of `hash`.
+static size_t hm_find_free(hash_map *map, uint64_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t pos = (size_t)(hash >> 7) & mask;
+
+  for (size_t stride = HM_GROUP_WIDTH;; stride += HM_GROUP_WIDTH) {
+    uint32_t free_slots = hm_group_match_free(map->ctrl + pos);
+    if (free_slots != 0)
+      return (pos + __builtin_ctz(free_slots)) & mask;
+    pos = (pos + stride) & mask;
+  }
+}
+
+// Moves every entry into fresh arrays of `capacity` slots, dropping tombstones.
+static int hm_rehash(hash_map *map, size_t capacity) {
+  size_t value_size = map->value_size ? map->value_size : 1;
+  if (capacity > SIZE_MAX - HM_GROUP_WIDTH ||
+      capacity > SIZE_MAX / map->key_size || capacity > SIZE_MAX / value_size)
+    return HM_ERR_ALLOC;
+
+  int8_t *ctrl = malloc(capacity + HM_GROUP_WIDTH);
+  void *keys = malloc(capacity * map->key_size);
+  void *values = malloc(capacity * value_size);
+  if (!ctrl || !keys || !values) {
+    free(ctrl);
+    free(keys);
+    free(values);
+    return HM_ERR_ALLOC;
+  }
+  memset(ctrl, HM_EMPTY, capacity + HM_GROUP_WIDTH);
+
+  hash_map old = *map;
+  map->ctrl = ctrl;
+  map->keys = keys;
+  map->values = values;
+  map->capacity = capacity;
+  map->growth_left = HM_MAX_LOAD(capacity) - map->count;
+
+  for (size_t slot = 0; slot < old.capacity; slot++) {
+    if (old.ctrl[slot] < 0)
+      continue;
+    uint64_t hash = map->hash(hm_key(&old, slot), map->key_size);
+    size_t target = hm_find_free(map, hash);
+    hm_set_ctrl(map, target, (int8_t)(hash & 0x7F));
+    memcpy(hm_key(map, target), hm_key(&old, slot), map->key_size);
+    memcpy(hm_value(map, target), hm_value(&old, slot), map->value_size);
+  }
+
+  free(old.ctrl);
+  free(old.keys);
+  free(old.values);
+  return HM_SUCCESS;
+}
+
+// Makes room for at least `count` entries without further rehashing.
+int hm_reserve(hash_map *map, size_t count) {
+  if (!map)
+    return HM_ERR_NULL;
+  if (map->key_size == 0)
+    return HM_ERR_UNINIT;
+
+  size_t capacity = HM_GROUP_WIDTH;
+  while (HM_MAX_LOAD(capacity) < count) {
+    if (capacity > SIZE_MAX / 2)
+      return HM_ERR_ALLOC;
+    capacity *= 2;
+  }
+  if (capacity <= map->capacity)
+    return HM_SUCCESS;
+  return hm_rehash(map, capacity);
+}
+
+void *hm_get_ptr(hash_map *map, const void *key) {
+  return hm_get_ptr_with(map, key, map ? map->key_size : 0,
+                         map ? map->hash : NULL, map ? map->equal : NULL);
+}
+
+int hm_get(hash_map *map, const void *key, void *value) {
+  return hm_get_with(map, key, value, map ? map->key_size : 0,
+                     map ? map->hash : NULL, map ? map->equal : NULL);
+}
+
+int hm_contains(hash_map *map, const void *key) {
+  return hm_get(map, key, NULL) == HM_SUCCESS;
+}
+
+int hm_put(hash_map *map, const void *key, const void *value) {
+  return hm_put_with(map, key, value, map ? map->key_size : 0,
+                     map ? map->hash : NULL, map ? map->equal : NULL);
+}
+
+int hm_remove(hash_map *map, const void *key) {
+  return hm_remove_with(map, key, map ? map->key_size : 0,
+                        map ? map->hash : NULL, map ? map->equal : NULL);
+}
+
+/*
+ * Inserts a key known not to be in the map, whose hash is `hash`, growing the
+ * map first if it is out of room.
+ */
+int hm_insert_new(hash_map *map, const void *key, const void *value,
+                  uint64_t hash) {
+  if (map->capacity == 0) {
+    if (hm_rehash(map, HM_GROUP_WIDTH) != HM_SUCCESS)
+      return HM_ERR_ALLOC;
+  }
+
+  size_t slot = hm_find_free(map, hash);
+  if (map->growth_left == 0 && map->ctrl[slot] == HM_EMPTY) {
+    // Out of room: grow, unless tombstones take up most of the map, in which
+    // case rehashing at the same size clears them.
+    size_t capacity = map->capacity;
+    if (map->count >= HM_MAX_LOAD(capacity) / 2) {
+      if (capacity > SIZE_MAX / 2)
+        return HM_ERR_ALLOC;
+      capacity *= 2;
+    }
+    if (hm_rehash(map, capacity) != HM_SUCCESS)
+      return HM_ERR_ALLOC;
+    slot = hm_find_free(map, hash);
+  }
+
+  if (map->ctrl[slot] == HM_EMPTY)
+    map->growth_left--;
+  hm_set_ctrl(map, slot, (int8_t)(hash & 0x7F));
+  memcpy(hm_key(map, slot), key, map->key_size);
+  if (map->value_size > 0)
+    memcpy(hm_value(map, slot), value, map->value_size);
+  map->count++;
+  return HM_SUCCESS;
+}
+
+/*
+ * Removes the entry in `slot`. The slot can go straight back to empty unless
+ * some probe may have walked past it while every group around it was full;
+ * only then does it need a tombstone. That is the case only if there is a
+ * window of HM_GROUP_WIDTH full slots around it, so tombstones stay rare.
+ */
+void hm_erase_slot(hash_map *map, size_t slot) {
+  size_t mask = map->capacity - 1;
+  uint32_t empty_after = hm_group_match(map->ctrl + slot, HM_EMPTY);
+  uint32_t empty_before = hm_group_match(
+      map->ctrl + ((slot - HM_GROUP_WIDTH) & mask), HM_EMPTY);
+
+  int never_full = empty_before != 0 && empty_after != 0 &&
+                   (size_t)(__builtin_ctz(empty_after) +
+                            __builtin_clz(empty_before) - (32 - HM_GROUP_WIDTH)) <
+                       HM_GROUP_WIDTH;
+
+  if (never_full) {
+    hm_set_ctrl(map, slot, HM_EMPTY);
+    map->growth_left++;
+  } else {
+    hm_set_ctrl(map, slot, HM_DELETED);
+  }
+  map->count--;
+}
+
+void hm_free(hash_map *map) {
+  if (!map)
+    return;
+  free(map->ctrl);
+  free(map->keys);
+  free(map->values);
+  map->ctrl = NULL;
+  map->keys = NULL;
+  map->values = NULL;
+  map->count = 0;
+  map->capacity = 0;
+  map->growth_left = 0;
+}
+
+#undef HM_MAX_LOAD
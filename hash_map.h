@@ -0,0 +1,203 @@
+/*
+ * @file: hash_map.h
+ * @brief: Declares the open-addressing hash map type, its functions, and the
+ * inline lookups HM_DEFINE builds on.
+ */
+
+#ifndef HASH_MAP_H
+#define HASH_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum hm_errors {
+  HM_SUCCESS = 0,
+  HM_ERR_NULL,
+  HM_ERR_UNINIT,
+  HM_ERR_ALLOC,
+  HM_ERR_NOT_FOUND
+};
+
+typedef uint64_t (*hm_hash_fn)(const void *key, size_t size);
+typedef int (*hm_equal_fn)(const void *a, const void *b, size_t size);
+
+/*
+ * Every slot has a control byte: HM_EMPTY, HM_DELETED, or the low 7 bits of
+ * the key's hash when it is full. A lookup loads the 16 control bytes starting
+ * at its probe position, compares them all against the hash bits at once and
+ * only looks at the keys whose byte matched; a group with an empty byte ends
+ * the probe. The control array has HM_GROUP_WIDTH extra bytes mirroring the
+ * first group, so a group can start at any slot without wrapping.
+ */
+typedef struct hash_map {
+  int8_t *ctrl;
+  void *keys;
+  void *values;
+  size_t key_size;
+  size_t value_size;
+  size_t count;
+  size_t capacity;
+  size_t growth_left;
+  hm_hash_fn hash;
+  hm_equal_fn equal;
+} hash_map;
+
+#define HM_GROUP_WIDTH 16
+#define HM_EMPTY ((int8_t)-128)
+#define HM_DELETED ((int8_t)-2)
+
+#define hm_key(map, slot) ((char *)(map)->keys + (slot) * (map)->key_size)
+#define hm_value(map, slot) ((char *)(map)->values + (slot) * (map)->value_size)
+
+char *hm_get_error_string(enum hm_errors error);
+int hm_init(hash_map *map, size_t key_size, size_t value_size, hm_hash_fn hash,
+            hm_equal_fn equal);
+int hm_reserve(hash_map *map, size_t count);
+void *hm_get_ptr(hash_map *map, const void *key);
+int hm_get(hash_map *map, const void *key, void *value);
+int hm_contains(hash_map *map, const void *key);
+int hm_put(hash_map *map, const void *key, const void *value);
+int hm_remove(hash_map *map, const void *key);
+void hm_free(hash_map *map);
+int hm_insert_new(hash_map *map, const void *key, const void *value,
+                  uint64_t hash);
+void hm_erase_slot(hash_map *map, size_t slot);
+
+// Bit i of the result is set when control byte i of the group equals `byte`.
+static inline uint32_t hm_group_match(const int8_t *group, int8_t byte) {
+#ifdef __SSE2__
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < HM_GROUP_WIDTH; i++)
+    mask |= (uint32_t)(group[i] == byte) << i;
+  return mask;
+#endif
+}
+
+/*
+ * Probes group by group with growing strides (triangular numbers of groups),
+ * which visits every group once since the capacity is a power of two.
+ * Returns the slot holding `key`, or SIZE_MAX. It takes the key size and
+ * `equal` as parameters so that HM_DEFINE can inline fixed ones.
+ */
+static inline size_t hm_find_slot_with(hash_map *map, const void *key,
+                                       uint64_t hash, size_t key_size,
+                                       hm_equal_fn equal) {
+  if (map->capacity == 0)
+    return SIZE_MAX;
+
+  size_t mask = map->capacity - 1;
+  int8_t h2 = (int8_t)(hash & 0x7F);
+  size_t pos = (size_t)(hash >> 7) & mask;
+
+  for (size_t stride = HM_GROUP_WIDTH;; stride += HM_GROUP_WIDTH) {
+    const int8_t *group = map->ctrl + pos;
+    uint32_t matches = hm_group_match(group, h2);
+    while (matches != 0) {
+      size_t slot = (pos + __builtin_ctz(matches)) & mask;
+      if (equal((char *)map->keys + slot * key_size, key, key_size))
+        return slot;
+      matches &= matches - 1;
+    }
+    if (hm_group_match(group, HM_EMPTY) != 0)
+      return SIZE_MAX;
+    pos = (pos + stride) & mask;
+  }
+}
+
+static inline void *hm_get_ptr_with(hash_map *map, const void *key,
+                                    size_t key_size, hm_hash_fn hash,
+                                    hm_equal_fn equal) {
+  if (!map || !key)
+    return NULL;
+
+  size_t slot =
+      hm_find_slot_with(map, key, hash(key, key_size), key_size, equal);
+  return (slot == SIZE_MAX) ? NULL : hm_value(map, slot);
+}
+
+static inline int hm_get_with(hash_map *map, const void *key, void *value,
+                              size_t key_size, hm_hash_fn hash,
+                              hm_equal_fn equal) {
+  if (!map || !key)
+    return HM_ERR_NULL;
+  if (map->key_size == 0)
+    return HM_ERR_UNINIT;
+
+  size_t slot =
+      hm_find_slot_with(map, key, hash(key, key_size), key_size, equal);
+  if (slot == SIZE_MAX)
+    return HM_ERR_NOT_FOUND;
+  if (value)
+    memcpy(value, hm_value(map, slot), map->value_size);
+  return HM_SUCCESS;
+}
+
+// Inserts `key` or overwrites its value if it is already present.
+static inline int hm_put_with(hash_map *map, const void *key,
+                              const void *value, size_t key_size,
+                              hm_hash_fn hash, hm_equal_fn equal) {
+  if (!map || !key || (!value && map->value_size > 0))
+    return HM_ERR_NULL;
+  if (map->key_size == 0)
+    return HM_ERR_UNINIT;
+
+  uint64_t hashed = hash(key, key_size);
+  size_t slot = hm_find_slot_with(map, key, hashed, key_size, equal);
+  if (slot == SIZE_MAX)
+    return hm_insert_new(map, key, value, hashed);
+  if (map->value_size > 0)
+    memcpy(hm_value(map, slot), value, map->value_size);
+  return HM_SUCCESS;
+}
+
+static inline int hm_remove_with(hash_map *map, const void *key,
+                                 size_t key_size, hm_hash_fn hash,
+                                 hm_equal_fn equal) {
+  if (!map || !key)
+    return HM_ERR_NULL;
+  if (map->key_size == 0)
+    return HM_ERR_UNINIT;
+
+  size_t slot =
+      hm_find_slot_with(map, key, hash(key, key_size), key_size, equal);
+  if (slot == SIZE_MAX)
+    return HM_ERR_NOT_FOUND;
+  hm_erase_slot(map, slot);
+  return HM_SUCCESS;
+}
+
+/*
+ * Defines prefix_get_ptr, prefix_get, prefix_contains, prefix_put and
+ * prefix_remove for keys of type `key_t`, with `hash` and `equal` fixed at
+ * compile time, so the compiler can inline them into the group probe instead
+ * of calling through map->hash and map->equal. The map still has to be set up
+ * with hm_init, with a key_size of sizeof(key_t) and the same two functions.
+ */
+#define HM_DEFINE(prefix, key_t, hash, equal)                                  \
+  static inline void *prefix##_get_ptr(hash_map *map, const key_t *key) {      \
+    return hm_get_ptr_with(map, key, sizeof(key_t), hash, equal);              \
+  }                                                                            \
+  static inline int prefix##_get(hash_map *map, const key_t *key,              \
+                                 void *value) {                                \
+    return hm_get_with(map, key, value, sizeof(key_t), hash, equal);           \
+  }                                                                            \
+  static inline int prefix##_contains(hash_map *map, const key_t *key) {       \
+    return prefix##_get(map, key, NULL) == HM_SUCCESS;                         \
+  }                                                                            \
+  static inline int prefix##_put(hash_map *map, const key_t *key,              \
+                                 const void *value) {                          \
+    return hm_put_with(map, key, value, sizeof(key_t), hash, equal);           \
+  }                                                                            \
+  static inline int prefix##_remove(hash_map *map, const key_t *key) {         \
+    return hm_remove_with(map, key, sizeof(key_t), hash, equal);               \
+  }
+
+#endif /* ifndef HASH_MAP_H */
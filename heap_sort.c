@@ -0,0 +1,85 @@
+/*
+ * @file: heap_sort.c
+ * @brief: Implements an in-place heap sort on a 4-ary max-heap.
+ * @compile: "clang -g -o heap_sort heap_sort.c"
+ * @run: "./heap_sort"
+ */
+
+#include <stdio.h>
+
+#ifndef swap //(x, y)
+#define swap(x, y)                                                             \
+  {                                                                            \
+    int temp = x;                                                              \
+    x = y;                                                                     \
+    y = temp;                                                                  \
+  }
+#endif /* ifndef swap(x, y) */
+
+// Four children per node keep the heap shallow and the siblings compared at
+// each level next to each other in memory.
+#define HEAP_ARITY 4
+
+void sift_down(int *arr, unsigned int pos, unsigned int len) {
+  int value = arr[pos];
+
+  while (1) {
+    unsigned int first = pos * HEAP_ARITY + 1;
+    if (first >= len)
+      break;
+
+    unsigned int last = first + HEAP_ARITY;
+    if (last > len)
+      last = len;
+
+    unsigned int largest = first;
+    for (unsigned int child = first + 1; child < last; child++) {
+      if (arr[child] > arr[largest])
+        largest = child;
+    }
+
+    if (arr[largest] <= value)
+      break;
+
+    arr[pos] = arr[largest];
+    pos = largest;
+  }
+
+  arr[pos] = value;
+}
+
+void heap_sort(int *arr, unsigned int len) {
+  if (len < 2)
+    return;
+
+  for (unsigned int i = (len - 2) / HEAP_ARITY + 1; i-- > 0;)
+    sift_down(arr, i, len);
+
+  for (unsigned int end = len - 1; end > 0; end--) {
+    swap(arr[0], arr[end]);
+    sift_down(arr, 0, end);
+  }
+}
+
+int main() {
+  int arr[] = {847, 123, 589, 312, 967, 634, 191, 456, 778, 245, 629, 883, 161,
+               717, 394, 538, 472, 855, 226, 981, 714, 369, 892, 437, 658, 175,
+               819, 286, 541, 764, 428, 695, 152, 873, 416, 587, 744, 271, 933,
+               596, 259, 822, 485, 748, 376, 631, 968, 193, 554, 777, 415, 684,
+               342, 879, 136, 763, 290, 857, 524, 488, 651, 374, 127, 982, 449,
+               566, 839, 297, 760, 523, 618, 385, 946, 572, 235, 789, 462, 178,
+               841, 694, 353, 276, 829, 187, 464, 591, 748, 375, 932, 283, 756,
+               469, 142, 896, 659, 374, 537, 188, 261, 795};
+
+  unsigned int len = sizeof(arr) / sizeof(arr[0]);
+
+  heap_sort(arr, len);
+
+  printf("Sorted array:\n");
+  for (int i = 0; i < len; i++) {
+    printf("%d ", arr[i]);
+  }
+  printf("\n");
+
+  return 0;
+}
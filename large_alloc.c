@@ -0,0 +1,360 @@
+/*
+ * @file: large_alloc.c
+ * @brief: Implements allocations for large arrays as anonymous mappings
+ * aligned to 2MB and advised to use transparent huge pages, optionally
+ * interleaved over NUMA nodes or placed by parallel first touch.
+ */
+
+#define _GNU_SOURCE
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "large_alloc.h"
+
+char *large_get_error_string(enum large_errors error) {
+  switch (error) {
+  case LARGE_SUCCESS:
+    return "SUCCESS";
+  case LARGE_ERR_NULL:
+    return "NULL_PARAMETER";
+  case LARGE_ERR_IO:
+    return "IO_ERROR";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+#define LARGE_MAX_NODES 1024
+#define LARGE_WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+// From <linux/mempolicy.h>, which is not always installed.
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+// Rounds `bytes` up to a whole number of huge pages, at least one.
+size_t large_round(size_t bytes) {
+  if (bytes == 0)
+    bytes = 1;
+  return (bytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1);
+}
+
+/*
+ * Maps `bytes` (a multiple of LARGE_PAGE_SIZE) starting on a huge page
+ * boundary, by over-mapping one huge page and trimming both ends.
+ */
+static char *large_reserve(size_t bytes, int prot) {
+  size_t span = bytes + LARGE_PAGE_SIZE;
+  char *raw = mmap(NULL, span, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED)
+    return NULL;
+
+  uintptr_t mask = LARGE_PAGE_SIZE - 1;
+  char *aligned = (char *)(((uintptr_t)raw + mask) & ~mask);
+  if (aligned > raw)
+    munmap(raw, (size_t)(aligned - raw));
+  size_t tail = (size_t)((raw + span) - (aligned + bytes));
+  if (tail > 0)
+    munmap(aligned + bytes, tail);
+  return aligned;
+}
+
+/*
+ * Reads a sysfs list of node or CPU numbers (like "0-1,4") from `path` into
+ * the bit mask `mask`. Returns one past the highest number, or 0 if the list
+ * can't be read.
+ */
+static unsigned long large_read_list(const char *path, unsigned long *mask,
+                                     size_t words) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+    return 0;
+
+  memset(mask, 0, words * sizeof(unsigned long));
+  unsigned long end = 0;
+  unsigned int first, last;
+  while (fscanf(f, "%u", &first) == 1) {
+    last = first;
+    int c = fgetc(f);
+    if (c == '-') {
+      if (fscanf(f, "%u", &last) != 1)
+        break;
+      c = fgetc(f);
+    }
+    for (unsigned int bit = first; bit <= last && bit < words * LARGE_WORD_BITS;
+         bit++) {
+      mask[bit / LARGE_WORD_BITS] |= 1UL << (bit % LARGE_WORD_BITS);
+      end = bit + 1;
+    }
+    if (c != ',')
+      break;
+  }
+
+  fclose(f);
+  return end;
+}
+
+#define large_bit(mask, bit)                                                   \
+  (((mask)[(bit) / LARGE_WORD_BITS] >> ((bit) % LARGE_WORD_BITS)) & 1)
+
+static unsigned long large_online_nodes(unsigned long *mask, size_t words) {
+  return large_read_list("/sys/devices/system/node/online", mask, words);
+}
+
+/*
+ * Best effort: without NUMA support in the kernel, or with a single node,
+ * there is nothing to interleave over and the pages go wherever the kernel
+ * puts them.
+ */
+static void large_interleave(char *ptr, size_t bytes) {
+#ifdef SYS_mbind
+  unsigned long mask[LARGE_MAX_NODES / LARGE_WORD_BITS];
+  unsigned long nodes =
+      large_online_nodes(mask, sizeof(mask) / sizeof(mask[0]));
+  if (nodes > 1)
+    syscall(SYS_mbind, ptr, bytes, MPOL_INTERLEAVE, mask, nodes + 1, 0);
+#else
+  (void)ptr;
+  (void)bytes;
+#endif
+}
+
+// Sets `cpus` to the CPUs of `node`. Returns 0 if they can't be read.
+static int large_node_cpus(unsigned int node, cpu_set_t *cpus) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+           node);
+  unsigned long mask[CPU_SETSIZE / LARGE_WORD_BITS];
+  unsigned long end =
+      large_read_list(path, mask, sizeof(mask) / sizeof(mask[0]));
+  if (end == 0)
+    return 0;
+
+  CPU_ZERO(cpus);
+  for (unsigned long cpu = 0; cpu < end; cpu++)
+    if (large_bit(mask, cpu))
+      CPU_SET(cpu, cpus);
+  return 1;
+}
+
+// Sets `attr` to run a thread on the CPUs of `node`. Returns 0 if it can't.
+static int large_attr_on_node(pthread_attr_t *attr, unsigned int node) {
+  cpu_set_t cpus;
+  return large_node_cpus(node, &cpus) &&
+         pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus) == 0;
+}
+
+// Fills `nodes` with the online nodes in order and returns how many there are.
+static unsigned int large_node_list(unsigned int *nodes) {
+  unsigned long mask[LARGE_MAX_NODES / LARGE_WORD_BITS];
+  unsigned int node_count = 0;
+  unsigned long end = large_online_nodes(mask, sizeof(mask) / sizeof(mask[0]));
+  for (unsigned long node = 0; node < end; node++)
+    if (large_bit(mask, node))
+      nodes[node_count++] = (unsigned int)node;
+  return node_count;
+}
+
+/*
+ * Sets `attr` to pin a thread to the CPUs of online node t * nodes / threads,
+ * the node where LARGE_NUMA_FIRST_TOUCH places slice t of `threads`, so that
+ * a parallel loop split into the same slices finds its memory local. Returns
+ * 0 if the nodes or their CPUs can't be read.
+ */
+int large_pin_attr(pthread_attr_t *attr, unsigned int t, unsigned int threads) {
+  if (!attr || threads == 0)
+    return 0;
+  unsigned int nodes[LARGE_MAX_NODES];
+  unsigned int node_count = large_node_list(nodes);
+  if (node_count == 0)
+    return 0;
+  return large_attr_on_node(attr, nodes[(size_t)t * node_count / threads]);
+}
+
+typedef struct large_slice {
+  char *start;
+  size_t bytes;
+  pthread_t thread;
+} large_slice;
+
+static void *large_touch(void *arg) {
+  large_slice *slice = arg;
+  memset(slice->start, 0, slice->bytes);
+  return NULL;
+}
+
+/*
+ * Starts the thread that zeroes `slice`, pinned to the CPUs of `node` if they
+ * can be read and the process may run there, and unpinned otherwise. Returns
+ * 0 if no thread could be started.
+ */
+static int large_start_touch(large_slice *slice, int pin, unsigned int node) {
+  pthread_attr_t attr;
+  if (pin && pthread_attr_init(&attr) == 0) {
+    int started =
+        large_attr_on_node(&attr, node) &&
+        pthread_create(&slice->thread, &attr, large_touch, slice) == 0;
+    pthread_attr_destroy(&attr);
+    if (started)
+      return 1;
+  }
+  return pthread_create(&slice->thread, NULL, large_touch, slice) == 0;
+}
+
+/*
+ * Zeroes `bytes` from `ptr` with `threads` threads (0 meaning one per online
+ * CPU), each taking a contiguous run of whole huge pages. Thread t is pinned
+ * to the CPUs of online node t * nodes / threads, so every page is faulted in
+ * on the node its slice belongs to.
+ */
+static void large_first_touch(char *ptr, size_t bytes, unsigned int threads) {
+  if (threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus > 0) ? (unsigned int)cpus : 1;
+  }
+  size_t pages = bytes / LARGE_PAGE_SIZE;
+  if (threads > pages)
+    threads = (unsigned int)pages;
+
+  large_slice *slices = malloc(threads * sizeof(large_slice));
+  if (slices == NULL || threads == 0) {
+    memset(ptr, 0, bytes);
+    free(slices);
+    return;
+  }
+
+  unsigned int nodes[LARGE_MAX_NODES];
+  unsigned int node_count = large_node_list(nodes);
+
+  // A slice whose thread can't be started is zeroed by the calling thread,
+  // and just misses its placement.
+  for (unsigned int t = 0; t < threads; t++) {
+    size_t first = pages * t / threads, last = pages * (t + 1) / threads;
+    slices[t].start = ptr + first * LARGE_PAGE_SIZE;
+    slices[t].bytes = (last - first) * LARGE_PAGE_SIZE;
+    unsigned int node =
+        (node_count > 0) ? nodes[(size_t)t * node_count / threads] : 0;
+    if (!large_start_touch(&slices[t], node_count > 0, node)) {
+      large_touch(&slices[t]);
+      slices[t].start = NULL;
+    }
+  }
+  for (unsigned int t = 0; t < threads; t++)
+    if (slices[t].start != NULL)
+      pthread_join(slices[t].thread, NULL);
+  free(slices);
+}
+
+static void large_place(char *ptr, size_t bytes, enum large_numa_policy numa,
+                        unsigned int threads) {
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+  if (numa == LARGE_NUMA_INTERLEAVE)
+    large_interleave(ptr, bytes);
+  else if (numa == LARGE_NUMA_FIRST_TOUCH)
+    large_first_touch(ptr, bytes, threads);
+}
+
+/*
+ * Allocates at least `bytes`, rounded up with large_round, on a huge page
+ * boundary. Returns NULL on failure. The memory reads as zero and must be
+ * released with large_free.
+ */
+void *large_alloc(size_t bytes, enum large_numa_policy numa,
+                  unsigned int threads) {
+  bytes = large_round(bytes);
+  char *ptr = large_reserve(bytes, PROT_READ | PROT_WRITE);
+  if (ptr == NULL)
+    return NULL;
+  large_place(ptr, bytes, numa, threads);
+  return ptr;
+}
+
+/*
+ * Resizes a large_alloc buffer. Shrinking unmaps the tail in place; growing
+ * moves the existing pages to a new aligned range with mremap instead of
+ * copying them, and only the new tail is placed by `numa`. Returns NULL and
+ * leaves `ptr` untouched on failure.
+ */
+void *large_realloc(void *ptr, size_t old_bytes, size_t new_bytes,
+                    enum large_numa_policy numa, unsigned int threads) {
+  if (ptr == NULL)
+    return large_alloc(new_bytes, numa, threads);
+
+  old_bytes = large_round(old_bytes);
+  new_bytes = large_round(new_bytes);
+  if (new_bytes <= old_bytes) {
+    if (new_bytes < old_bytes)
+      munmap((char *)ptr + new_bytes, old_bytes - new_bytes);
+    return ptr;
+  }
+
+#ifdef MREMAP_FIXED
+  char *target = large_reserve(new_bytes, PROT_NONE);
+  if (target == NULL)
+    return NULL;
+  char *moved = mremap(ptr, old_bytes, new_bytes,
+                       MREMAP_MAYMOVE | MREMAP_FIXED, target);
+  if (moved == MAP_FAILED) {
+    munmap(target, new_bytes);
+    return NULL;
+  }
+  large_place(moved + old_bytes, new_bytes - old_bytes, numa, threads);
+#else
+  char *moved = large_alloc(new_bytes, numa, threads);
+  if (moved == NULL)
+    return NULL;
+  memcpy(moved, ptr, old_bytes);
+  munmap(ptr, old_bytes);
+#endif
+  return moved;
+}
+
+void large_free(void *ptr, size_t bytes) {
+  if (ptr != NULL)
+    munmap(ptr, large_round(bytes));
+}
+
+/*
+ * Counts the huge pages backing the buffer, from the AnonHugePages lines of
+ * /proc/self/smaps. The kernel reports them per mapping, so a neighbouring
+ * mapping the kernel merged with this one is counted too.
+ */
+int large_huge_pages(const void *ptr, size_t bytes, size_t *pages) {
+  if (!ptr || !pages)
+    return LARGE_ERR_NULL;
+
+  FILE *f = fopen("/proc/self/smaps", "r");
+  if (f == NULL)
+    return LARGE_ERR_IO;
+
+  uintptr_t low = (uintptr_t)ptr, high = low + large_round(bytes);
+  int inside = 0;
+  size_t kb = 0;
+  char line[512];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    unsigned long start, end;
+    size_t value;
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+      inside = start < high && end > low;
+    else if (inside && sscanf(line, "AnonHugePages: %zu kB", &value) == 1)
+      kb += value;
+  }
+
+  fclose(f);
+  *pages = kb * 1024 / LARGE_PAGE_SIZE;
+  return LARGE_SUCCESS;
+}
+
+#undef large_bit
+#undef LARGE_WORD_BITS
+#undef LARGE_MAX_NODES
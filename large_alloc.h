@@ -0,0 +1,45 @@
+/*
+ * @file: large_alloc.h
+ * @brief: Declares an allocator for multi-gigabyte buffers backed by
+ * transparent huge pages, with a choice of NUMA placement.
+ */
+
+#ifndef LARGE_ALLOC_H
+#define LARGE_ALLOC_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+enum large_errors {
+  LARGE_SUCCESS = 0,
+  LARGE_ERR_NULL,
+  LARGE_ERR_IO
+};
+
+/*
+ * LARGE_NUMA_INTERLEAVE spreads pages round-robin over every online node, for
+ * memory all threads use evenly. LARGE_NUMA_FIRST_TOUCH splits the buffer into
+ * `threads` equal contiguous slices and has thread t, pinned to the CPUs of
+ * online node t * nodes / threads, zero slice t so that its pages land on that
+ * node. A parallel loop split the same way finds its slices local when its
+ * threads run on the same nodes.
+ */
+enum large_numa_policy {
+  LARGE_NUMA_DEFAULT = 0,
+  LARGE_NUMA_INTERLEAVE,
+  LARGE_NUMA_FIRST_TOUCH
+};
+
+#define LARGE_PAGE_SIZE ((size_t)2 << 20)
+
+char *large_get_error_string(enum large_errors error);
+size_t large_round(size_t bytes);
+void *large_alloc(size_t bytes, enum large_numa_policy numa,
+                  unsigned int threads);
+void *large_realloc(void *ptr, size_t old_bytes, size_t new_bytes,
+                    enum large_numa_policy numa, unsigned int threads);
+void large_free(void *ptr, size_t bytes);
+int large_huge_pages(const void *ptr, size_t bytes, size_t *pages);
+int large_pin_attr(pthread_attr_t *attr, unsigned int t, unsigned int threads);
+
+#endif /* ifndef LARGE_ALLOC_H */
@@ -1,11 +1,22 @@
 /*
  * @file: 2.7_merge_sort.c
  * @brief: Implements a simple merge sort algorithm.
- * @compile: "clang -g -o 2.7_merge_sort 2.7_merge_sort.c"
+ * @compile: "clang -g -pthread -o 2.7_merge_sort 2.7_merge_sort.c
+ * large_alloc.c"
  * @run: "./2.7_merge_sort"
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+
+#include "large_alloc.h"
+
+/*
+ * Merging needs a scratch copy of the array. It is allocated once up front
+ * rather than on the stack at every level, and past this size it comes from
+ * large_alloc, on huge pages interleaved over the NUMA nodes.
+ */
+#define MERGE_LARGE_SCRATCH ((size_t)64 << 20)
 
 #ifndef swap //(x, y)
 #define swap(x, y)                                                             \
@@ -16,12 +27,13 @@
   }
 #endif /* ifndef swap(x, y) */
 
-void merge(int *arr, unsigned int low, unsigned int mid, unsigned int high) {
+void merge(int *arr, int *scratch, unsigned int low, unsigned int mid,
+           unsigned int high) {
   int i, j, k;
   int n1 = mid - low + 1;
   int n2 = high - mid;
 
-  int left[n1], right[n2];
+  int *left = scratch + low, *right = scratch + mid + 1;
 
   for (i = 0; i < n1; i++)
     left[i] = arr[low + i];
@@ -57,15 +69,30 @@ void merge(int *arr, unsigned int low, unsigned int mid, unsigned int high) {
   }
 }
 
-void merge_sort(int *arr, unsigned int low, unsigned int high) {
+void merge_sort(int *arr, int *scratch, unsigned int low, unsigned int high) {
   if (low < high) {
     int mid = (low + high) / 2;
-    merge_sort(arr, low, mid);
-    merge_sort(arr, mid + 1, high);
-    merge(arr, low, mid, high);
+    merge_sort(arr, scratch, low, mid);
+    merge_sort(arr, scratch, mid + 1, high);
+    merge(arr, scratch, low, mid, high);
   }
 }
 
+int *merge_scratch_alloc(size_t len) {
+  size_t bytes = len * sizeof(int);
+  if (bytes >= MERGE_LARGE_SCRATCH)
+    return large_alloc(bytes, LARGE_NUMA_INTERLEAVE, 0);
+  return malloc(bytes);
+}
+
+void merge_scratch_free(int *scratch, size_t len) {
+  size_t bytes = len * sizeof(int);
+  if (bytes >= MERGE_LARGE_SCRATCH)
+    large_free(scratch, bytes);
+  else
+    free(scratch);
+}
+
 int main() {
   int arr[] = {847, 123, 589, 312, 967, 634, 191, 456, 778, 245, 629, 883, 161,
                717, 394, 538, 472, 855, 226, 981, 714, 369, 892, 437, 658, 175,
@@ -81,7 +108,13 @@ int main() {
   unsigned int low = 0;
   unsigned int high = len - 1;
 
-  merge_sort(arr, low, high);
+  int *scratch = merge_scratch_alloc(len);
+  if (scratch == NULL) {
+    printf("Could not allocate the scratch buffer\n");
+    return 1;
+  }
+  merge_sort(arr, scratch, low, high);
+  merge_scratch_free(scratch, len);
 
   printf("Sorted array:\n");
   for (int i = 0; i < len; i++) {
@@ -0,0 +1,529 @@
+/*
+ * @file: parallel_sort.c
+ * @brief: Implements a parallel sample sort for large int arrays: splitters
+ * chosen from a random sample, a scatter of every item into its bucket's
+ * range through software write-combining buffers flushed a cache line at a
+ * time with non-temporal stores, and an LSD radix sort of each bucket on its
+ * own, so the buckets come out in order with no final merge. Workers are
+ * pinned to NUMA nodes the way large_alloc's first-touch threads are.
+ * @compile: "clang -O2 -pthread -o parallel_sort parallel_sort.c
+ * large_alloc.c"
+ * @run: "./parallel_sort [count] [threads]"
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "large_alloc.h"
+
+#define PSORT_MAX_THREADS 256
+// More buckets than threads, handed out as threads finish, so one bucket
+// that came out large doesn't leave the others idle.
+#define PSORT_BUCKETS_PER_THREAD 4
+#define PSORT_MAX_BUCKETS (PSORT_MAX_THREADS * PSORT_BUCKETS_PER_THREAD)
+#define PSORT_OVERSAMPLE 64
+// One 64-byte cache line of ints per bucket and thread.
+#define PSORT_WC_ITEMS 16
+#define PSORT_SMALL 64
+#define PSORT_SEQUENTIAL ((size_t)1 << 16)
+#define PSORT_LARGE_SCRATCH ((size_t)64 << 20)
+
+// Flipping the sign bit makes the unsigned digits order negatives first.
+#define psort_key(x) ((uint32_t)(x) ^ 0x80000000u)
+
+void insertion_sort_range(int *arr, size_t len) {
+  for (size_t i = 1; i < len; i++) {
+    int value = arr[i];
+    size_t j = i;
+    while (j > 0 && arr[j - 1] > value) {
+      arr[j] = arr[j - 1];
+      j--;
+    }
+    arr[j] = value;
+  }
+}
+
+/*
+ * LSD radix sort, 8 bits per pass, moving the items back and forth between
+ * `arr` and `scratch` (which must hold `len` ints). All four histograms are
+ * counted in one read of the input, and a pass whose digit is the same for
+ * every item is skipped, which is common inside a sample sort bucket.
+ * Returns whichever of the two buffers ended up holding the sorted items.
+ */
+int *radix_sort(int *arr, int *scratch, size_t len) {
+  if (len < PSORT_SMALL) {
+    insertion_sort_range(arr, len);
+    return arr;
+  }
+
+  size_t count[4][256] = {{0}};
+  for (size_t i = 0; i < len; i++) {
+    uint32_t key = psort_key(arr[i]);
+    count[0][key & 0xFF]++;
+    count[1][(key >> 8) & 0xFF]++;
+    count[2][(key >> 16) & 0xFF]++;
+    count[3][key >> 24]++;
+  }
+
+  int *src = arr, *dst = scratch;
+  for (unsigned int pass = 0; pass < 4; pass++) {
+    unsigned int shift = pass * 8;
+    if (count[pass][(psort_key(src[0]) >> shift) & 0xFF] == len)
+      continue;
+
+    size_t sum = 0;
+    for (unsigned int digit = 0; digit < 256; digit++) {
+      size_t c = count[pass][digit];
+      count[pass][digit] = sum;
+      sum += c;
+    }
+    for (size_t i = 0; i < len; i++)
+      dst[count[pass][(psort_key(src[i]) >> shift) & 0xFF]++] = src[i];
+
+    int *temp = src;
+    src = dst;
+    dst = temp;
+  }
+  return src;
+}
+
+typedef struct psort_shared {
+  int *arr;
+  int *out;
+  size_t len;
+  unsigned int threads;
+  unsigned int buckets;
+  int splitters[PSORT_MAX_BUCKETS - 1];
+  // counts[t * buckets + b]: how many of thread t's items go to bucket b,
+  // and after the prefix sum, where in `out` it writes the first of them.
+  size_t *counts;
+  size_t bucket_start[PSORT_MAX_BUCKETS + 1];
+  int (*wc)[PSORT_WC_ITEMS];
+  // Whether full lines of `out` are written with non-temporal stores.
+  int stream;
+  _Atomic unsigned int next_bucket;
+  pthread_barrier_t barrier;
+  // Workers wait for `go` to become 1 (sort) or -1 (give up) before reading
+  // anything else, since `threads` is only final once they have all started.
+  pthread_mutex_t lock;
+  pthread_cond_t started;
+  int go;
+} psort_shared;
+
+typedef struct psort_thread {
+  psort_shared *shared;
+  pthread_t thread;
+  unsigned int id;
+} psort_thread;
+
+// The number of splitters less than `x`, or not greater than it if
+// `or_equal`.
+static unsigned int psort_count_below(const int *splitters, unsigned int n,
+                                      int x, int or_equal) {
+  unsigned int low = 0;
+  while (n > 0) {
+    unsigned int half = n / 2;
+    int below = or_equal ? splitters[low + half] <= x
+                         : splitters[low + half] < x;
+    if (below) {
+      low += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return low;
+}
+
+/*
+ * The bucket of `x` is the number of splitters not greater than it. When the
+ * input repeats a key so often that several splitters equal it, the buckets
+ * between those splitters would be empty and the key would all land in the
+ * bucket after them, so instead it is spread over the buckets between, by its
+ * index `i`. Such a bucket holds nothing but that key and needs no sorting.
+ */
+static unsigned int psort_bucket_of(const int *splitters, unsigned int buckets,
+                                    int x, size_t i) {
+  unsigned int high = psort_count_below(splitters, buckets - 1, x, 1);
+  if (high < 2 || splitters[high - 2] != x)
+    return high;
+  unsigned int low = psort_count_below(splitters, high - 2, x, 0);
+  return low + 1 + (unsigned int)(i % (high - 1 - low));
+}
+
+// Whether bucket `b` lies between two equal splitters.
+#define psort_equal_bucket(s, b)                                               \
+  ((b) > 0 && (b) < (s)->buckets - 1 &&                                        \
+   (s)->splitters[(b) - 1] == (s)->splitters[(b)])
+
+/*
+ * Copies the `n` items a bucket's buffer holds for the cache line of `out`
+ * that ends just before `end`. A whole line goes out with non-temporal stores
+ * when `stream` is set, so the scatter neither reads each line of `out` into
+ * the cache before overwriting it nor evicts the input to make room. `out`
+ * is then from large_alloc, so its lines are 64-byte aligned like the buffers.
+ */
+static inline void psort_flush(int *end, const int (*wc)[PSORT_WC_ITEMS],
+                               unsigned int n, int stream) {
+  int *dst = end - n;
+  const int *src = *wc + PSORT_WC_ITEMS - n;
+#ifdef __SSE2__
+  if (stream && n == PSORT_WC_ITEMS) {
+    for (unsigned int k = 0; k < PSORT_WC_ITEMS / 4; k++)
+      _mm_stream_si128((__m128i *)dst + k,
+                       _mm_load_si128((const __m128i *)src + k));
+    return;
+  }
+#else
+  (void)stream;
+#endif
+  memcpy(dst, src, n * sizeof(int));
+}
+
+/*
+ * Each thread owns one contiguous slice of the input. It counts how many of
+ * its items fall in each bucket, then (after the prefix sum over all threads)
+ * copies them to their place in `out` through a small buffer per bucket
+ * instead of one scattered store per item. An item for position p of `out`
+ * sits in slot p % PSORT_WC_ITEMS, and the buffer is flushed whenever p ends
+ * a cache line, so every flush but a bucket's first and last fills a whole
+ * line. Finally threads
+ * take whole buckets from a shared counter, sort them and put them back in
+ * the input, using the bucket's range of the input, now free, as scratch.
+ * A bucket of one repeated key is just copied back.
+ */
+static void *psort_worker(void *arg) {
+  psort_thread *t = arg;
+  psort_shared *s = t->shared;
+  pthread_mutex_lock(&s->lock);
+  while (s->go == 0)
+    pthread_cond_wait(&s->started, &s->lock);
+  pthread_mutex_unlock(&s->lock);
+  if (s->go < 0)
+    return NULL;
+
+  unsigned int buckets = s->buckets;
+  size_t first = s->len * t->id / s->threads;
+  size_t last = s->len * (t->id + 1) / s->threads;
+  size_t *count = s->counts + (size_t)t->id * buckets;
+
+  for (size_t i = first; i < last; i++)
+    count[psort_bucket_of(s->splitters, buckets, s->arr[i], i)]++;
+
+  pthread_barrier_wait(&s->barrier);
+  if (t->id == 0) {
+    size_t position = 0;
+    for (unsigned int b = 0; b < buckets; b++) {
+      s->bucket_start[b] = position;
+      for (unsigned int thread = 0; thread < s->threads; thread++) {
+        size_t c = s->counts[(size_t)thread * buckets + b];
+        s->counts[(size_t)thread * buckets + b] = position;
+        position += c;
+      }
+    }
+    s->bucket_start[buckets] = position;
+  }
+  pthread_barrier_wait(&s->barrier);
+
+  int(*wc)[PSORT_WC_ITEMS] = s->wc + (size_t)t->id * buckets;
+  unsigned char fill[PSORT_MAX_BUCKETS] = {0};
+  for (size_t i = first; i < last; i++) {
+    int x = s->arr[i];
+    unsigned int b = psort_bucket_of(s->splitters, buckets, x, i);
+    size_t position = count[b]++;
+    wc[b][position % PSORT_WC_ITEMS] = x;
+    fill[b]++;
+    if (count[b] % PSORT_WC_ITEMS == 0) {
+      psort_flush(s->out + count[b], &wc[b], fill[b], s->stream);
+      fill[b] = 0;
+    }
+  }
+  // What is left of each bucket ends mid-line.
+  for (unsigned int b = 0; b < buckets; b++) {
+    size_t position = count[b] - fill[b];
+    memcpy(s->out + position, wc[b] + position % PSORT_WC_ITEMS,
+           fill[b] * sizeof(int));
+  }
+#ifdef __SSE2__
+  // Non-temporal stores are weakly ordered, so they are fenced before other
+  // threads read `out`.
+  if (s->stream)
+    _mm_sfence();
+#endif
+
+  pthread_barrier_wait(&s->barrier);
+  unsigned int b;
+  while ((b = atomic_fetch_add_explicit(&s->next_bucket, 1,
+                                        memory_order_relaxed)) < buckets) {
+    size_t start = s->bucket_start[b];
+    size_t n = s->bucket_start[b + 1] - start;
+    int *sorted = psort_equal_bucket(s, b)
+                      ? s->out + start
+                      : radix_sort(s->out + start, s->arr + start, n);
+    if (sorted != s->arr + start)
+      memcpy(s->arr + start, sorted, n * sizeof(int));
+  }
+  return NULL;
+}
+
+/*
+ * Starts worker `t` pinned to the node where large_alloc's first-touch thread
+ * t of `threads` puts its slice, so that its slice of an input allocated that
+ * way is local, and unpinned if that fails. Returns 0 if no thread could be
+ * started.
+ */
+static int psort_start_worker(psort_thread *t, unsigned int threads) {
+  pthread_attr_t attr;
+  if (pthread_attr_init(&attr) == 0) {
+    int started = large_pin_attr(&attr, t->id, threads) &&
+                  pthread_create(&t->thread, &attr, psort_worker, t) == 0;
+    pthread_attr_destroy(&attr);
+    if (started)
+      return 1;
+  }
+  return pthread_create(&t->thread, NULL, psort_worker, t) == 0;
+}
+
+static uint64_t psort_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/*
+ * Picks buckets - 1 splitters from a sorted random sample of
+ * PSORT_OVERSAMPLE items per bucket, so every bucket gets close to len /
+ * buckets items whatever the distribution of the input.
+ */
+static int psort_choose_splitters(psort_shared *s) {
+  size_t samples = (size_t)s->buckets * PSORT_OVERSAMPLE;
+  int *sample = malloc(2 * samples * sizeof(int));
+  if (sample == NULL)
+    return -1;
+
+  uint64_t state = 0x9E3779B97F4A7C15ULL ^ s->len;
+  for (size_t i = 0; i < samples; i++)
+    sample[i] = s->arr[psort_random(&state) % s->len];
+  int *sorted = radix_sort(sample, sample + samples, samples);
+  for (unsigned int b = 1; b < s->buckets; b++)
+    s->splitters[b - 1] = sorted[(size_t)b * PSORT_OVERSAMPLE];
+
+  free(sample);
+  return 0;
+}
+
+static int *psort_scratch_alloc(size_t len) {
+  size_t bytes = len * sizeof(int);
+  if (bytes >= PSORT_LARGE_SCRATCH)
+    return large_alloc(bytes, LARGE_NUMA_INTERLEAVE, 0);
+  return malloc(bytes);
+}
+
+static void psort_scratch_free(int *scratch, size_t len) {
+  size_t bytes = len * sizeof(int);
+  if (bytes >= PSORT_LARGE_SCRATCH)
+    large_free(scratch, bytes);
+  else
+    free(scratch);
+}
+
+/*
+ * Sorts `len` ints with `threads` threads (0 meaning one per online CPU).
+ * Needs a scratch buffer as large as the input, which past
+ * PSORT_LARGE_SCRATCH is interleaved over the NUMA nodes, as every thread
+ * writes all over it. Thread t reads slice t of `arr`, so an input from
+ * large_alloc with LARGE_NUMA_FIRST_TOUCH and the same `threads` is read
+ * from local memory. Returns -1 if memory runs out, leaving `arr` unchanged.
+ */
+int parallel_sort(int *arr, size_t len, unsigned int threads) {
+  if (threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus > 0) ? (unsigned int)cpus : 1;
+  }
+  if (threads > PSORT_MAX_THREADS)
+    threads = PSORT_MAX_THREADS;
+  if (len < PSORT_SEQUENTIAL)
+    threads = 1;
+  if (len < 2)
+    return 0;
+
+  int result = -1;
+  int *out = psort_scratch_alloc(len);
+  if (out == NULL)
+    return -1;
+
+  if (threads == 1) {
+    int *sorted = radix_sort(arr, out, len);
+    if (sorted != arr)
+      memcpy(arr, sorted, len * sizeof(int));
+    psort_scratch_free(out, len);
+    return 0;
+  }
+
+  psort_shared *s = malloc(sizeof(psort_shared));
+  psort_thread *workers = malloc(threads * sizeof(psort_thread));
+  size_t max_buckets = (size_t)threads * PSORT_BUCKETS_PER_THREAD;
+  if (s == NULL || workers == NULL)
+    goto done;
+  s->counts = calloc(threads * max_buckets, sizeof(size_t));
+  s->wc = aligned_alloc(64, threads * max_buckets * sizeof(*s->wc));
+  if (s->counts == NULL || s->wc == NULL)
+    goto done_buffers;
+
+  s->arr = arr;
+  s->out = out;
+  s->len = len;
+  s->stream = len * sizeof(int) >= PSORT_LARGE_SCRATCH;
+  s->go = 0;
+  atomic_init(&s->next_bucket, 0);
+  pthread_mutex_init(&s->lock, NULL);
+  pthread_cond_init(&s->started, NULL);
+
+  // Every worker gets its own pinned thread. If a thread can't be started,
+  // the sort goes ahead with the ones that were, or with none, in the
+  // calling thread as the only worker.
+  unsigned int started = 0;
+  for (; started < threads; started++) {
+    workers[started].shared = s;
+    workers[started].id = started;
+    if (!psort_start_worker(&workers[started], threads))
+      break;
+  }
+
+  s->threads = (started > 0) ? started : 1;
+  s->buckets = s->threads * PSORT_BUCKETS_PER_THREAD;
+  int go = (psort_choose_splitters(s) == 0) ? 1 : -1;
+  if (go > 0)
+    pthread_barrier_init(&s->barrier, NULL, s->threads);
+  pthread_mutex_lock(&s->lock);
+  s->go = go;
+  pthread_cond_broadcast(&s->started);
+  pthread_mutex_unlock(&s->lock);
+
+  if (started == 0) {
+    workers[0].shared = s;
+    workers[0].id = 0;
+    psort_worker(&workers[0]);
+  }
+  for (unsigned int i = 0; i < started; i++)
+    pthread_join(workers[i].thread, NULL);
+
+  if (go > 0) {
+    pthread_barrier_destroy(&s->barrier);
+    result = 0;
+  }
+  pthread_cond_destroy(&s->started);
+  pthread_mutex_destroy(&s->lock);
+
+done_buffers:
+  free(s->wc);
+  free(s->counts);
+done:
+  free(workers);
+  free(s);
+  psort_scratch_free(out, len);
+  return result;
+}
+
+// An order-independent fingerprint of the items, to check that sorting only
+// moved them around.
+static uint64_t psort_fingerprint(const int *arr, size_t len) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint64_t h = (uint64_t)(uint32_t)arr[i] * 0x9E3779B97F4A7C15ULL;
+    sum += h ^ (h >> 31);
+  }
+  return sum;
+}
+
+static double psort_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Sorts `count` random ints, and checks that they come out in order and that
+ * sorting only moved them around. With `distinct` 0 the ints are spread over
+ * the whole range, with a run of duplicates and both signs; otherwise they
+ * take only `distinct` values, which puts several splitters on the same key.
+ */
+static int psort_check(size_t count, unsigned int threads,
+                       unsigned int distinct) {
+  int *big = large_alloc(count * sizeof(int), LARGE_NUMA_FIRST_TOUCH, threads);
+  if (big == NULL) {
+    printf("Could not allocate %zu ints\n", count);
+    return 0;
+  }
+  uint64_t state = 88172645463325252ULL;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t r = psort_random(&state);
+    if (distinct > 0)
+      big[i] = (int)(r % distinct) - (int)(distinct / 2);
+    else
+      big[i] = (i % 8 == 0) ? 42 : (int)r;
+  }
+
+  uint64_t before = psort_fingerprint(big, count);
+  double begin = psort_now();
+  int result = parallel_sort(big, count, threads);
+  double elapsed = psort_now() - begin;
+
+  int sorted = (result == 0);
+  for (size_t i = 1; sorted && i < count; i++)
+    sorted = big[i - 1] <= big[i];
+  sorted = sorted && psort_fingerprint(big, count) == before;
+  if (distinct > 0)
+    printf("Sorted %zu ints of %u values in %.3f s: %s\n", count, distinct,
+           elapsed, sorted ? "ok" : "NOT SORTED");
+  else
+    printf("Sorted %zu random ints in %.3f s: %s\n", count, elapsed,
+           sorted ? "ok" : "NOT SORTED");
+
+  large_free(big, count * sizeof(int));
+  return sorted;
+}
+
+int main(int argc, char **argv) {
+  int arr[] = {847, 123, 589, 312, 967, 634, 191, 456, 778, 245, 629, 883, 161,
+               717, 394, 538, 472, 855, 226, 981, 714, 369, 892, 437, 658, 175,
+               819, 286, 541, 764, 428, 695, 152, 873, 416, 587, 744, 271, 933,
+               596, 259, 822, 485, 748, 376, 631, 968, 193, 554, 777, 415, 684,
+               342, 879, 136, 763, 290, 857, 524, 488, 651, 374, 127, 982, 449,
+               566, 839, 297, 760, 523, 618, 385, 946, 572, 235, 789, 462, 178,
+               841, 694, 353, 276, 829, 187, 464, 591, 748, 375, 932, 283, 756,
+               469, 142, 896, 659, 374, 537, 188, 261, 795};
+
+  unsigned int len = sizeof(arr) / sizeof(arr[0]);
+
+  if (parallel_sort(arr, len, 0) != 0) {
+    printf("Could not allocate the scratch buffer\n");
+    return 1;
+  }
+
+  printf("Sorted array:\n");
+  for (unsigned int i = 0; i < len; i++) {
+    printf("%d ", arr[i]);
+  }
+  printf("\n");
+
+  // Then large arrays, to exercise the parallel path.
+  size_t count = (argc > 1) ? strtoull(argv[1], NULL, 10) : (size_t)1 << 24;
+  unsigned int threads = (argc > 2) ? (unsigned int)atoi(argv[2]) : 0;
+  int ok = psort_check(count, threads, 0);
+  ok &= psort_check(count, threads, 3);
+  return ok ? 0 : 1;
+}
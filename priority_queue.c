@@ -0,0 +1,152 @@
+/*
+ * @file: priority_queue.c
+ * @brief: Implements a d-ary heap priority queue stored in a dynamic array,
+ * with optional handles for decrease-key.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "priority_queue.h"
+
+char *pq_get_error_string(enum pq_errors error) {
+  switch (error) {
+  case PQ_SUCCESS:
+    return "SUCCESS";
+  case PQ_ERR_NULL:
+    return "NULL_PARAMETER";
+  case PQ_ERR_INDEX:
+    return "INDEX_ERROR";
+  case PQ_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case PQ_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case PQ_ERR_EMPTY:
+    return "QUEUE_EMPTY";
+  case PQ_ERR_KEY:
+    return "KEY_ERROR";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+#define PQ_DEFAULT_ARITY 4
+
+int pq_init(priority_queue *pq, size_t item_size, size_t arity,
+            pq_compare_fn cmp, int use_handles) {
+  if (!pq || !cmp)
+    return PQ_ERR_NULL;
+  if (item_size == 0)
+    return PQ_ERR_UNINIT;
+
+  pq->arity = (arity < 2) ? PQ_DEFAULT_ARITY : arity;
+  pq->use_handles = use_handles;
+  pq->cmp = cmp;
+  pq->scratch = malloc(item_size);
+  if (!pq->scratch)
+    return PQ_ERR_ALLOC;
+
+  if (da_init(&pq->items, item_size) != DA_SUCCESS)
+    goto fail_items;
+  if (use_handles) {
+    if (da_init(&pq->handle_at, sizeof(size_t)) != DA_SUCCESS)
+      goto fail_handle_at;
+    if (da_init(&pq->position_of, sizeof(size_t)) != DA_SUCCESS)
+      goto fail_position_of;
+    if (da_init(&pq->free_handles, sizeof(size_t)) != DA_SUCCESS)
+      goto fail_free_handles;
+  }
+  return PQ_SUCCESS;
+
+fail_free_handles:
+  da_free(&pq->position_of);
+fail_position_of:
+  da_free(&pq->handle_at);
+fail_handle_at:
+  da_free(&pq->items);
+fail_items:
+  free(pq->scratch);
+  pq->scratch = NULL;
+  return PQ_ERR_ALLOC;
+}
+
+// Appends `item` at the bottom of the heap without restoring heap order.
+int pq_append(priority_queue *pq, void *item, size_t *handle) {
+  if (da_push(&pq->items, item) != DA_SUCCESS)
+    return PQ_ERR_ALLOC;
+  if (!pq->use_handles)
+    return PQ_SUCCESS;
+
+  size_t pos = pq->items.count - 1;
+  size_t id;
+  // DA_ERR_RESIZE means the handle was popped but the array didn't shrink.
+  int reused = da_pop_item(&pq->free_handles, &id);
+  if (reused == DA_ERR_EMPTY) {
+    id = pq->position_of.count;
+    if (da_push(&pq->position_of, &pos) != DA_SUCCESS)
+      goto fail;
+  } else if (reused != DA_SUCCESS && reused != DA_ERR_RESIZE) {
+    goto fail;
+  }
+  if (da_push(&pq->handle_at, &id) != DA_SUCCESS) {
+    // If the handle can't go back on the free list it is only leaked: it
+    // stays marked as not in the queue.
+    pq_position_of(pq)[id] = PQ_NO_POSITION;
+    da_push(&pq->free_handles, &id);
+    goto fail;
+  }
+
+  pq_position_of(pq)[id] = pos;
+  if (handle)
+    *handle = id;
+  return PQ_SUCCESS;
+
+fail:
+  pq_drop_last(&pq->items);
+  return PQ_ERR_ALLOC;
+}
+
+int pq_push(priority_queue *pq, void *item, size_t *handle) {
+  return pq_push_with(pq, item, handle, pq ? pq->cmp : NULL);
+}
+
+int pq_pop(priority_queue *pq, void *item) {
+  return pq_pop_with(pq, item, pq ? pq->cmp : NULL);
+}
+
+int pq_push_batch(priority_queue *pq, void *items, size_t count,
+                  size_t *handles) {
+  return pq_push_batch_with(pq, items, count, handles, pq ? pq->cmp : NULL);
+}
+
+int pq_decrease_key(priority_queue *pq, size_t handle, void *item) {
+  return pq_decrease_key_with(pq, handle, item, pq ? pq->cmp : NULL);
+}
+
+int pq_top(priority_queue *pq, void *item) {
+  if (!pq || !item)
+    return PQ_ERR_NULL;
+  if (!pq->scratch)
+    return PQ_ERR_UNINIT;
+  if (pq->items.count == 0)
+    return PQ_ERR_EMPTY;
+
+  memcpy(item, pq_item(pq, 0), pq->items.item_size);
+  return PQ_SUCCESS;
+}
+
+void pq_free(priority_queue *pq) {
+  if (!pq)
+    return;
+  da_free(&pq->items);
+  if (pq->use_handles) {
+    da_free(&pq->handle_at);
+    da_free(&pq->position_of);
+    da_free(&pq->free_handles);
+  }
+  free(pq->scratch);
+  pq->scratch = NULL;
+}
+
+#undef PQ_DEFAULT_ARITY
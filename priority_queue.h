@@ -0,0 +1,268 @@
+/*
+ * @file: priority_queue.h
+ * @brief: Declares the d-ary heap priority queue and its functions, along with
+ * the inline heap operations PQ_DEFINE builds on.
+ */
+
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dynamic_array.h"
+
+enum pq_errors {
+  PQ_SUCCESS = 0,
+  PQ_ERR_NULL,
+  PQ_ERR_INDEX,
+  PQ_ERR_UNINIT,
+  PQ_ERR_ALLOC,
+  PQ_ERR_EMPTY,
+  PQ_ERR_KEY
+};
+
+// cmp(a, b) < 0 means `a` leaves the queue before `b`.
+typedef int (*pq_compare_fn)(const void *a, const void *b);
+
+/*
+ * Items sit in `items` in heap order; the children of position i are
+ * arity * i + 1 ... arity * i + arity. With `use_handles` set every push hands
+ * out a handle that stays valid until that item is popped, `handle_at` maps
+ * heap positions to handles and `position_of` maps handles back to positions.
+ */
+typedef struct priority_queue {
+  dynamic_array items;
+  dynamic_array handle_at;
+  dynamic_array position_of;
+  dynamic_array free_handles;
+  size_t arity;
+  int use_handles;
+  pq_compare_fn cmp;
+  void *scratch;
+} priority_queue;
+
+#define PQ_NO_POSITION SIZE_MAX
+
+#define pq_item(pq, pos) ((char *)(pq)->items.items + (pos) * (pq)->items.item_size)
+#define pq_handle_at(pq) ((size_t *)(pq)->handle_at.items)
+#define pq_position_of(pq) ((size_t *)(pq)->position_of.items)
+
+char *pq_get_error_string(enum pq_errors error);
+int pq_init(priority_queue *pq, size_t item_size, size_t arity,
+            pq_compare_fn cmp, int use_handles);
+int pq_append(priority_queue *pq, void *item, size_t *handle);
+int pq_push(priority_queue *pq, void *item, size_t *handle);
+int pq_pop(priority_queue *pq, void *item);
+int pq_push_batch(priority_queue *pq, void *items, size_t count,
+                  size_t *handles);
+int pq_decrease_key(priority_queue *pq, size_t handle, void *item);
+int pq_top(priority_queue *pq, void *item);
+void pq_free(priority_queue *pq);
+
+static inline void pq_place(priority_queue *pq, size_t to, const void *item,
+                            size_t handle) {
+  memcpy(pq_item(pq, to), item, pq->items.item_size);
+  if (pq->use_handles) {
+    pq_handle_at(pq)[to] = handle;
+    pq_position_of(pq)[handle] = to;
+  }
+}
+
+/*
+ * The sift functions carry the item being moved in `scratch` and shift the
+ * others into the hole it leaves, one copy per level instead of a swap.
+ * They take the comparator as a parameter so that PQ_DEFINE can inline a
+ * fixed one.
+ */
+static inline void pq_sift_up(priority_queue *pq, size_t pos,
+                              pq_compare_fn cmp) {
+  size_t handle = pq->use_handles ? pq_handle_at(pq)[pos] : 0;
+  memcpy(pq->scratch, pq_item(pq, pos), pq->items.item_size);
+
+  while (pos > 0) {
+    size_t parent = (pos - 1) / pq->arity;
+    if (cmp(pq->scratch, pq_item(pq, parent)) >= 0)
+      break;
+    pq_place(pq, pos, pq_item(pq, parent),
+             pq->use_handles ? pq_handle_at(pq)[parent] : 0);
+    pos = parent;
+  }
+
+  pq_place(pq, pos, pq->scratch, handle);
+}
+
+static inline void pq_sift_down(priority_queue *pq, size_t pos,
+                                pq_compare_fn cmp) {
+  size_t count = pq->items.count;
+  size_t handle = pq->use_handles ? pq_handle_at(pq)[pos] : 0;
+  memcpy(pq->scratch, pq_item(pq, pos), pq->items.item_size);
+
+  for (;;) {
+    size_t first = pos * pq->arity + 1;
+    if (first >= count)
+      break;
+    size_t last = (count - first < pq->arity) ? count : first + pq->arity;
+
+    size_t best = first;
+    for (size_t child = first + 1; child < last; child++)
+      if (cmp(pq_item(pq, child), pq_item(pq, best)) < 0)
+        best = child;
+
+    if (cmp(pq_item(pq, best), pq->scratch) >= 0)
+      break;
+    pq_place(pq, pos, pq_item(pq, best),
+             pq->use_handles ? pq_handle_at(pq)[best] : 0);
+    pos = best;
+  }
+
+  pq_place(pq, pos, pq->scratch, handle);
+}
+
+static inline int pq_push_with(priority_queue *pq, void *item, size_t *handle,
+                               pq_compare_fn cmp) {
+  if (!pq || !item)
+    return PQ_ERR_NULL;
+  if (!pq->scratch)
+    return PQ_ERR_UNINIT;
+
+  int result = pq_append(pq, item, handle);
+  if (result != PQ_SUCCESS)
+    return result;
+
+  pq_sift_up(pq, pq->items.count - 1, cmp);
+  return PQ_SUCCESS;
+}
+
+/*
+ * Drops the last item of one of the queue's arrays. Only the shrink after it
+ * can fail, and that leaves the array valid, just larger than it needs to be.
+ */
+static inline int pq_drop_last(dynamic_array *da) {
+  int result = da_remove_item(da, da->count - 1);
+  if (result != DA_SUCCESS && result != DA_ERR_RESIZE)
+    return PQ_ERR_INDEX;
+  return PQ_SUCCESS;
+}
+
+static inline int pq_pop_with(priority_queue *pq, void *item,
+                              pq_compare_fn cmp) {
+  if (!pq)
+    return PQ_ERR_NULL;
+  if (!pq->scratch)
+    return PQ_ERR_UNINIT;
+  if (pq->items.count == 0)
+    return PQ_ERR_EMPTY;
+
+  // Freeing the handle is the one step that can run out of memory, so it is
+  // done before anything else changes.
+  size_t last = pq->items.count - 1;
+  size_t popped = pq->use_handles ? pq_handle_at(pq)[0] : 0;
+  if (pq->use_handles && da_push(&pq->free_handles, &popped) != DA_SUCCESS)
+    return PQ_ERR_ALLOC;
+
+  if (item)
+    memcpy(item, pq_item(pq, 0), pq->items.item_size);
+
+  int result = PQ_SUCCESS;
+  if (pq->use_handles) {
+    pq_position_of(pq)[popped] = PQ_NO_POSITION;
+    pq_handle_at(pq)[0] = pq_handle_at(pq)[last];
+    result = pq_drop_last(&pq->handle_at);
+  }
+  if (last > 0)
+    memcpy(pq_item(pq, 0), pq_item(pq, last), pq->items.item_size);
+  if (result == PQ_SUCCESS)
+    result = pq_drop_last(&pq->items);
+  if (result != PQ_SUCCESS)
+    return result;
+
+  if (pq->items.count > 0)
+    pq_sift_down(pq, 0, cmp);
+  return PQ_SUCCESS;
+}
+
+/*
+ * Pushes `count` items from the array `items`, returning their handles in
+ * `handles` when it isn't NULL. A batch at least as large as the queue is
+ * appended as is and the whole heap rebuilt in O(n); smaller ones are sifted
+ * up one by one.
+ */
+static inline int pq_push_batch_with(priority_queue *pq, void *items,
+                                     size_t count, size_t *handles,
+                                     pq_compare_fn cmp) {
+  if (!pq || (!items && count > 0))
+    return PQ_ERR_NULL;
+  if (!pq->scratch)
+    return PQ_ERR_UNINIT;
+
+  size_t before = pq->items.count;
+  int rebuild = count >= before;
+
+  for (size_t i = 0; i < count; i++) {
+    void *item = (char *)items + i * pq->items.item_size;
+    int result = pq_append(pq, item, handles ? &handles[i] : NULL);
+    if (result != PQ_SUCCESS) {
+      rebuild = 1;
+      count = i;
+      break;
+    }
+    if (!rebuild)
+      pq_sift_up(pq, pq->items.count - 1, cmp);
+  }
+
+  if (rebuild && pq->items.count > 1)
+    for (size_t pos = (pq->items.count - 2) / pq->arity + 1; pos-- > 0;)
+      pq_sift_down(pq, pos, cmp);
+
+  return (pq->items.count == before + count) ? PQ_SUCCESS : PQ_ERR_ALLOC;
+}
+
+/*
+ * Replaces `handle`'s item with `item`, which must not order after the old
+ * one, and moves it up accordingly.
+ */
+static inline int pq_decrease_key_with(priority_queue *pq, size_t handle,
+                                       void *item, pq_compare_fn cmp) {
+  if (!pq || !item)
+    return PQ_ERR_NULL;
+  if (!pq->scratch || !pq->use_handles)
+    return PQ_ERR_UNINIT;
+  if (handle >= pq->position_of.count ||
+      pq_position_of(pq)[handle] == PQ_NO_POSITION)
+    return PQ_ERR_INDEX;
+
+  size_t pos = pq_position_of(pq)[handle];
+  if (cmp(item, pq_item(pq, pos)) > 0)
+    return PQ_ERR_KEY;
+
+  memcpy(pq_item(pq, pos), item, pq->items.item_size);
+  pq_sift_up(pq, pos, cmp);
+  return PQ_SUCCESS;
+}
+
+/*
+ * Defines prefix_push, prefix_pop, prefix_push_batch and prefix_decrease_key
+ * with `cmp` fixed at compile time, so the compiler can inline it into the
+ * sift loops instead of calling through pq->cmp. The queue still has to be
+ * set up with pq_init, and with the same comparator.
+ */
+#define PQ_DEFINE(prefix, cmp)                                                 \
+  static inline int prefix##_push(priority_queue *pq, void *item,              \
+                                  size_t *handle) {                            \
+    return pq_push_with(pq, item, handle, cmp);                                \
+  }                                                                            \
+  static inline int prefix##_pop(priority_queue *pq, void *item) {             \
+    return pq_pop_with(pq, item, cmp);                                         \
+  }                                                                            \
+  static inline int prefix##_push_batch(priority_queue *pq, void *items,       \
+                                        size_t count, size_t *handles) {       \
+    return pq_push_batch_with(pq, items, count, handles, cmp);                 \
+  }                                                                            \
+  static inline int prefix##_decrease_key(priority_queue *pq, size_t handle,   \
+                                          void *item) {                        \
+    return pq_decrease_key_with(pq, handle, item, cmp);                        \
+  }
+
+#endif /* ifndef PRIORITY_QUEUE_H */
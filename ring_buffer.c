@@ -0,0 +1,283 @@
+/*
+ * @file: ring_buffer.c
+ * @brief: Implements bounded lock-free FIFO queues on a power-of-two ring
+ * buffer: a wait-free single-producer/single-consumer ring and a
+ * multi-producer/multi-consumer ring.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring_buffer.h"
+
+char *ring_get_error_string(enum ring_errors error) {
+  switch (error) {
+  case RING_SUCCESS:
+    return "SUCCESS";
+  case RING_ERR_NULL:
+    return "NULL_PARAMETER";
+  case RING_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case RING_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case RING_ERR_FULL:
+    return "RING_FULL";
+  case RING_ERR_EMPTY:
+    return "RING_EMPTY";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+// Rounds `capacity` up to a power of two, or returns 0 if that overflows.
+static size_t ring_round_capacity(size_t capacity) {
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    if (rounded > ((size_t)-1 >> 1))
+      return 0;
+    rounded <<= 1;
+  }
+  return rounded;
+}
+
+int spsc_ring_init(spsc_ring *r, size_t item_size, size_t capacity) {
+  if (!r)
+    return RING_ERR_NULL;
+  if (item_size == 0)
+    return RING_ERR_UNINIT;
+
+  capacity = ring_round_capacity(capacity);
+  if (capacity == 0)
+    return RING_ERR_ALLOC;
+
+  r->items = malloc(capacity * item_size);
+  if (!r->items)
+    return RING_ERR_ALLOC;
+
+  atomic_init(&r->head, 0);
+  atomic_init(&r->tail, 0);
+  r->cached_head = 0;
+  r->cached_tail = 0;
+  r->item_size = item_size;
+  r->mask = capacity - 1;
+  return RING_SUCCESS;
+}
+
+/*
+ * Enqueues up to `count` items from the contiguous array `items` and returns
+ * how many fit. Only the producer thread may call this.
+ */
+size_t spsc_ring_enqueue_batch(spsc_ring *r, const void *items, size_t count) {
+  if (!r || !items || !r->items)
+    return 0;
+
+  size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  size_t capacity = r->mask + 1;
+  size_t free_slots = capacity - (tail - r->cached_head);
+  if (free_slots < count) {
+    r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+    free_slots = capacity - (tail - r->cached_head);
+  }
+  if (count > free_slots)
+    count = free_slots;
+  if (count == 0)
+    return 0;
+
+  // At most two copies: up to the end of the buffer, then from its start.
+  size_t start = tail & r->mask;
+  size_t first = (count < capacity - start) ? count : capacity - start;
+  memcpy(r->items + start * r->item_size, items, first * r->item_size);
+  memcpy(r->items, (const unsigned char *)items + first * r->item_size,
+         (count - first) * r->item_size);
+
+  atomic_store_explicit(&r->tail, tail + count, memory_order_release);
+  return count;
+}
+
+/*
+ * Dequeues up to `count` items into the contiguous array `items` and returns
+ * how many were available. Only the consumer thread may call this.
+ */
+size_t spsc_ring_dequeue_batch(spsc_ring *r, void *items, size_t count) {
+  if (!r || !items || !r->items)
+    return 0;
+
+  size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  size_t available = r->cached_tail - head;
+  if (available < count) {
+    r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    available = r->cached_tail - head;
+  }
+  if (count > available)
+    count = available;
+  if (count == 0)
+    return 0;
+
+  size_t capacity = r->mask + 1;
+  size_t start = head & r->mask;
+  size_t first = (count < capacity - start) ? count : capacity - start;
+  memcpy(items, r->items + start * r->item_size, first * r->item_size);
+  memcpy((unsigned char *)items + first * r->item_size, r->items,
+         (count - first) * r->item_size);
+
+  atomic_store_explicit(&r->head, head + count, memory_order_release);
+  return count;
+}
+
+int spsc_ring_enqueue(spsc_ring *r, const void *item) {
+  if (!r || !item)
+    return RING_ERR_NULL;
+  if (!r->items)
+    return RING_ERR_UNINIT;
+  return spsc_ring_enqueue_batch(r, item, 1) ? RING_SUCCESS : RING_ERR_FULL;
+}
+
+int spsc_ring_dequeue(spsc_ring *r, void *item) {
+  if (!r || !item)
+    return RING_ERR_NULL;
+  if (!r->items)
+    return RING_ERR_UNINIT;
+  return spsc_ring_dequeue_batch(r, item, 1) ? RING_SUCCESS : RING_ERR_EMPTY;
+}
+
+void spsc_ring_free(spsc_ring *r) {
+  if (!r)
+    return;
+  free(r->items);
+  r->items = NULL;
+  r->item_size = 0;
+  r->mask = 0;
+}
+
+#define mpmc_slot(r, pos) ((r)->slots + ((pos) & (r)->mask) * (r)->slot_size)
+#define mpmc_sequence(slot) ((_Atomic size_t *)(slot))
+#define mpmc_item(slot) ((slot) + sizeof(_Atomic size_t))
+
+int mpmc_ring_init(mpmc_ring *r, size_t item_size, size_t capacity) {
+  if (!r)
+    return RING_ERR_NULL;
+  if (item_size == 0)
+    return RING_ERR_UNINIT;
+
+  capacity = ring_round_capacity(capacity);
+  if (capacity == 0)
+    return RING_ERR_ALLOC;
+
+  size_t align = sizeof(_Atomic size_t);
+  r->slot_size = (sizeof(_Atomic size_t) + item_size + align - 1) / align * align;
+  r->slots = malloc(capacity * r->slot_size);
+  if (!r->slots)
+    return RING_ERR_ALLOC;
+
+  r->item_size = item_size;
+  r->mask = capacity - 1;
+  for (size_t pos = 0; pos < capacity; pos++)
+    atomic_init(mpmc_sequence(mpmc_slot(r, pos)), pos);
+  atomic_init(&r->enqueue_pos, 0);
+  atomic_init(&r->dequeue_pos, 0);
+  return RING_SUCCESS;
+}
+
+/*
+ * Claims up to `count` consecutive positions from `counter`, whose slots must
+ * have the sequence `pos + offset` to be ready. Returns how many were claimed
+ * and the first of them in `first`.
+ */
+static size_t mpmc_claim(mpmc_ring *r, _Atomic size_t *counter, size_t offset,
+                         size_t count, size_t *first) {
+  size_t pos = atomic_load_explicit(counter, memory_order_relaxed);
+  for (;;) {
+    size_t ready = 0;
+    while (ready < count) {
+      size_t seq = atomic_load_explicit(
+          mpmc_sequence(mpmc_slot(r, pos + ready)), memory_order_acquire);
+      if (seq != pos + ready + offset)
+        break;
+      ready++;
+    }
+
+    if (ready == 0) {
+      // Either the ring is full (empty) or another thread got here first.
+      size_t seq = atomic_load_explicit(mpmc_sequence(mpmc_slot(r, pos)),
+                                        memory_order_acquire);
+      if ((ptrdiff_t)(seq - (pos + offset)) < 0)
+        return 0;
+      pos = atomic_load_explicit(counter, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(counter, &pos, pos + ready,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed)) {
+      *first = pos;
+      return ready;
+    }
+  }
+}
+
+// Enqueues up to `count` items from the array `items`, returns how many fit.
+size_t mpmc_ring_enqueue_batch(mpmc_ring *r, const void *items, size_t count) {
+  if (!r || !items || !r->slots || count == 0)
+    return 0;
+
+  size_t first;
+  size_t claimed = mpmc_claim(r, &r->enqueue_pos, 0, count, &first);
+  for (size_t i = 0; i < claimed; i++) {
+    unsigned char *slot = mpmc_slot(r, first + i);
+    memcpy(mpmc_item(slot), (const unsigned char *)items + i * r->item_size,
+           r->item_size);
+    atomic_store_explicit(mpmc_sequence(slot), first + i + 1,
+                          memory_order_release);
+  }
+  return claimed;
+}
+
+// Dequeues up to `count` items into the array `items`, returns how many.
+size_t mpmc_ring_dequeue_batch(mpmc_ring *r, void *items, size_t count) {
+  if (!r || !items || !r->slots || count == 0)
+    return 0;
+
+  size_t first;
+  size_t claimed = mpmc_claim(r, &r->dequeue_pos, 1, count, &first);
+  for (size_t i = 0; i < claimed; i++) {
+    unsigned char *slot = mpmc_slot(r, first + i);
+    memcpy((unsigned char *)items + i * r->item_size, mpmc_item(slot),
+           r->item_size);
+    atomic_store_explicit(mpmc_sequence(slot), first + i + r->mask + 1,
+                          memory_order_release);
+  }
+  return claimed;
+}
+
+int mpmc_ring_enqueue(mpmc_ring *r, const void *item) {
+  if (!r || !item)
+    return RING_ERR_NULL;
+  if (!r->slots)
+    return RING_ERR_UNINIT;
+  return mpmc_ring_enqueue_batch(r, item, 1) ? RING_SUCCESS : RING_ERR_FULL;
+}
+
+int mpmc_ring_dequeue(mpmc_ring *r, void *item) {
+  if (!r || !item)
+    return RING_ERR_NULL;
+  if (!r->slots)
+    return RING_ERR_UNINIT;
+  return mpmc_ring_dequeue_batch(r, item, 1) ? RING_SUCCESS : RING_ERR_EMPTY;
+}
+
+// Not thread-safe: every other thread must be done with the ring.
+void mpmc_ring_free(mpmc_ring *r) {
+  if (!r)
+    return;
+  free(r->slots);
+  r->slots = NULL;
+  r->item_size = 0;
+  r->slot_size = 0;
+  r->mask = 0;
+}
+
+#undef mpmc_item
+#undef mpmc_sequence
+#undef mpmc_slot
@@ -0,0 +1,71 @@
+/*
+ * @file: ring_buffer.h
+ * @brief: Declares the SPSC and MPMC ring buffer queues and their functions.
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+enum ring_errors {
+  RING_SUCCESS = 0,
+  RING_ERR_NULL,
+  RING_ERR_UNINIT,
+  RING_ERR_ALLOC,
+  RING_ERR_FULL,
+  RING_ERR_EMPTY
+};
+
+#define RING_CACHE_LINE 64
+
+/*
+ * Single producer, single consumer. `head` is only written by the consumer and
+ * `tail` only by the producer, each on its own cache line. Both sides also
+ * keep a private copy of the other side's index and only re-read the shared
+ * one when the copy says the ring is full (or empty), so in the steady state
+ * neither side pulls in the other's cache line on every operation.
+ */
+typedef struct spsc_ring {
+  _Alignas(RING_CACHE_LINE) _Atomic size_t head;
+  size_t cached_tail;
+  _Alignas(RING_CACHE_LINE) _Atomic size_t tail;
+  size_t cached_head;
+  _Alignas(RING_CACHE_LINE) unsigned char *items;
+  size_t item_size;
+  size_t mask;
+} spsc_ring;
+
+/*
+ * Multiple producers, multiple consumers (Vyukov's bounded queue). Every slot
+ * carries a sequence number saying whose turn it is: a slot at position `pos`
+ * is free for the producer claiming `pos` when its sequence equals `pos`, and
+ * holds an item for the consumer claiming `pos` when it equals `pos + 1`.
+ * Producers and consumers claim positions with a CAS on their own counter and
+ * then only touch the slots they claimed.
+ */
+typedef struct mpmc_ring {
+  _Alignas(RING_CACHE_LINE) _Atomic size_t enqueue_pos;
+  _Alignas(RING_CACHE_LINE) _Atomic size_t dequeue_pos;
+  _Alignas(RING_CACHE_LINE) unsigned char *slots;
+  size_t item_size;
+  size_t slot_size;
+  size_t mask;
+} mpmc_ring;
+
+char *ring_get_error_string(enum ring_errors error);
+int spsc_ring_init(spsc_ring *r, size_t item_size, size_t capacity);
+size_t spsc_ring_enqueue_batch(spsc_ring *r, const void *items, size_t count);
+size_t spsc_ring_dequeue_batch(spsc_ring *r, void *items, size_t count);
+int spsc_ring_enqueue(spsc_ring *r, const void *item);
+int spsc_ring_dequeue(spsc_ring *r, void *item);
+void spsc_ring_free(spsc_ring *r);
+int mpmc_ring_init(mpmc_ring *r, size_t item_size, size_t capacity);
+size_t mpmc_ring_enqueue_batch(mpmc_ring *r, const void *items, size_t count);
+size_t mpmc_ring_dequeue_batch(mpmc_ring *r, void *items, size_t count);
+int mpmc_ring_enqueue(mpmc_ring *r, const void *item);
+int mpmc_ring_dequeue(mpmc_ring *r, void *item);
+void mpmc_ring_free(mpmc_ring *r);
+
+#endif /* ifndef RING_BUFFER_H */
@@ -5,13 +5,7 @@
 
 #include <stdlib.h>
 
-enum sll_errors {
-  SLL_SUCCESS = 0,
-  SLL_ERR_NULL,
-  SLL_ERR_INDEX,
-  SLL_ERR_UNINIT,
-  SLL_ERR_ALLOC
-};
+#include "singly_linked_list.h"
 
 char *sll_get_error_string(enum sll_errors error) {
   switch (error) {
@@ -30,16 +24,63 @@ char *sll_get_error_string(enum sll_errors error) {
   }
 }
 
-typedef struct Node {
-  void *data;
-  struct Node *next;
-} Node;
+/*
+ * Nodes belonging to a List are carved out of cache-line-aligned slabs instead
+ * of being malloc'd one at a time. Fresh nodes are handed out sequentially from
+ * the newest slab, so nodes allocated together sit next to each other in
+ * memory, and deleted nodes are recycled through a free list.
+ */
+#define SLL_CACHE_LINE 64
+#define SLL_SLAB_SIZE 4096
+
+#define SLL_SLAB_HEADER                                                        \
+  ((sizeof(sll_slab) + SLL_CACHE_LINE - 1) / SLL_CACHE_LINE * SLL_CACHE_LINE)
+#define SLL_SLAB_NODES ((SLL_SLAB_SIZE - SLL_SLAB_HEADER) / sizeof(Node))
+
+static Node *sll_pool_alloc(List *list, void *data) {
+  Node *node = list->free_nodes;
+
+  if (node != NULL) {
+    list->free_nodes = node->next;
+  } else {
+    if (list->slabs == NULL || list->slab_used == SLL_SLAB_NODES) {
+      sll_slab *slab = aligned_alloc(SLL_CACHE_LINE, SLL_SLAB_SIZE);
+      if (slab == NULL)
+        return NULL;
+      slab->next = list->slabs;
+      list->slabs = slab;
+      list->slab_used = 0;
+      telemetry_add(list, TELEMETRY_LIST, allocations, 1);
+      telemetry_add(list, TELEMETRY_LIST, bytes_allocated, SLL_SLAB_SIZE);
+      telemetry_add(list, TELEMETRY_LIST, grows, 1);
+    }
+    node = (Node *)((char *)list->slabs + SLL_SLAB_HEADER) + list->slab_used;
+    list->slab_used++;
+  }
+
+  node->data = data;
+  node->next = NULL;
+  telemetry_peak(list, TELEMETRY_LIST, peak_capacity, list->length + 1);
+  return node;
+}
+
+static void sll_pool_release(List *list, Node *node) {
+  node->next = list->free_nodes;
+  list->free_nodes = node;
+}
 
-typedef struct List {
-  Node *head;
-  Node *tail;
-  size_t length;
-} List;
+// Leaves `list` empty without touching any memory it might have referenced.
+static void sll_list_reset(List *list) {
+  list->head = NULL;
+  list->tail = NULL;
+  list->length = 0;
+  list->slabs = NULL;
+  list->free_nodes = NULL;
+  list->slab_used = 0;
+  list->cache_node = NULL;
+  list->cache_index = 0;
+  telemetry_clear(list);
+}
 
 Node *sll_create_node(void *data) {
   Node *newnode = malloc(sizeof(Node));
@@ -53,7 +94,8 @@ Node *sll_create_node(void *data) {
 }
 
 int sll_list_init(List *list, void *data) {
-  list->head = sll_create_node(data);
+  sll_list_reset(list);
+  list->head = sll_pool_alloc(list, data);
 
   if (list->head == NULL) {
     return SLL_ERR_ALLOC;
@@ -65,6 +107,26 @@ int sll_list_init(List *list, void *data) {
   return SLL_SUCCESS;
 }
 
+/*
+ * The list remembers the last node reached by index. Lookups at or after that
+ * index resume from it instead of from the head, so walking the list with
+ * increasing indices costs O(n) in total. Structural changes keep the cached
+ * index in step or drop the cache when its node goes away.
+ */
+static void sll_cache_inserted(List *list, size_t index, size_t count) {
+  if (list->cache_node != NULL && list->cache_index >= index)
+    list->cache_index += count;
+}
+
+static void sll_cache_removed(List *list, size_t index) {
+  if (list->cache_node == NULL || list->cache_index < index)
+    return;
+  if (list->cache_index == index)
+    list->cache_node = NULL;
+  else
+    list->cache_index--;
+}
+
 Node *sll_get_at_index(List *list, size_t index) {
   if (!list || list->head == NULL || list->length == 0 ||
       index >= list->length) {
@@ -72,13 +134,25 @@ Node *sll_get_at_index(List *list, size_t index) {
   }
 
   Node *node = list->head;
-
   size_t pos = 0;
+
+  if (index == list->length - 1) {
+    node = list->tail;
+    pos = index;
+  } else if (list->cache_node != NULL && list->cache_index <= index) {
+    node = list->cache_node;
+    pos = list->cache_index;
+  }
+
+  telemetry_add(list, TELEMETRY_LIST, traversals, 1);
+  telemetry_add(list, TELEMETRY_LIST, node_hops, index - pos);
   while (pos < index) {
     node = node->next;
     pos++;
   }
 
+  list->cache_node = node;
+  list->cache_index = index;
   return node;
 }
 
@@ -89,13 +163,14 @@ int sll_prepend_node(List *list, void *data) {
   if (!list || list->head == NULL || list->length == 0)
     return SLL_ERR_UNINIT;
 
-  Node *newnode = sll_create_node(data);
+  Node *newnode = sll_pool_alloc(list, data);
   if (newnode == NULL)
     return SLL_ERR_ALLOC;
 
   newnode->next = list->head;
   list->head = newnode;
   list->length++;
+  sll_cache_inserted(list, 0, 1);
   return SLL_SUCCESS;
 }
 
@@ -106,7 +181,7 @@ int sll_append_node(List *list, void *data) {
   if (!list || list->head == NULL || list->length == 0)
     return SLL_ERR_UNINIT;
 
-  Node *newnode = sll_create_node(data);
+  Node *newnode = sll_pool_alloc(list, data);
   if (newnode == NULL)
     return SLL_ERR_ALLOC;
 
@@ -130,27 +205,21 @@ int sll_insert_node(List *list, size_t index, void *data) {
     return SLL_ERR_INDEX;
   }
 
-  Node *prev_node = list->head;
-  size_t prev_node_pos = 0;
-
-  while (prev_node_pos < index - 1) {
-    prev_node = prev_node->next;
-    prev_node_pos++;
-  }
-
-  Node *at_index = sll_get_at_index(list, index);
-  Node *inserted_node = sll_create_node(data);
+  Node *prev_node = sll_get_at_index(list, index - 1);
+  Node *inserted_node = sll_pool_alloc(list, data);
   if (inserted_node == NULL)
     return SLL_ERR_ALLOC;
 
+  inserted_node->next = prev_node->next;
   prev_node->next = inserted_node;
-  inserted_node->next = at_index;
 
   if (index == list->length) {
     list->tail = inserted_node;
   }
 
   list->length++;
+  list->cache_node = inserted_node;
+  list->cache_index = index;
   return SLL_SUCCESS;
 }
 
@@ -168,11 +237,17 @@ int sll_delete_head(List *list) {
     list->tail = NULL;
   }
 
-  free(head);
+  sll_pool_release(list, head);
   list->length--;
+  sll_cache_removed(list, 0);
   return SLL_SUCCESS;
 }
 
+/*
+ * The tail has no link back to the node before it, so this walks to that node
+ * from the head, or from the index cache when it sits before the tail: O(n)
+ * in general. Deleting from the head, or through a cursor, is O(1).
+ */
 int sll_delete_tail(List *list) {
   if (!list)
     return SLL_ERR_NULL;
@@ -181,15 +256,13 @@ int sll_delete_tail(List *list) {
     return SLL_ERR_UNINIT;
 
   if (list->length == 1) {
-    free(list->head);
+    sll_pool_release(list, list->head);
     list->head = NULL;
     list->tail = NULL;
+    list->cache_node = NULL;
   } else {
-    Node *new_tail = list->head;
-    while (new_tail->next->next != NULL) {
-      new_tail = new_tail->next;
-    }
-    free(new_tail->next);
+    Node *new_tail = sll_get_at_index(list, list->length - 2);
+    sll_pool_release(list, new_tail->next);
     new_tail->next = NULL;
     list->tail = new_tail;
   }
@@ -213,24 +286,375 @@ int sll_delete_at_index(List *list, size_t index) {
     return sll_delete_head(list);
   } else if (index == list->length - 1) {
     return sll_delete_tail(list);
-  } else if (index >= list->length) {
-    return SLL_ERR_INDEX;
   }
 
-  Node *prev_node = list->head;
-  size_t prev_node_pos = 0;
+  Node *prev_node = sll_get_at_index(list, index - 1);
+  Node *at_index = prev_node->next;
+  prev_node->next = at_index->next;
+
+  sll_pool_release(list, at_index);
+  list->length--;
+  return SLL_SUCCESS;
+}
+
+int sll_cursor_init(sll_cursor *cursor, List *list) {
+  if (!cursor || !list)
+    return SLL_ERR_NULL;
+
+  cursor->list = list;
+  cursor->prev = NULL;
+  cursor->node = list->head;
+  cursor->index = 0;
+  return SLL_SUCCESS;
+}
+
+int sll_cursor_seek(sll_cursor *cursor, List *list, size_t index) {
+  if (!cursor || !list)
+    return SLL_ERR_NULL;
+
+  if (list->head == NULL || list->length == 0)
+    return SLL_ERR_UNINIT;
+
+  if (index > list->length)
+    return SLL_ERR_INDEX;
 
-  while (prev_node_pos < index - 1) {
-    prev_node = prev_node->next;
-    prev_node_pos++;
+  cursor->list = list;
+  cursor->index = index;
+  if (index == 0) {
+    cursor->prev = NULL;
+    cursor->node = list->head;
+  } else {
+    cursor->prev = sll_get_at_index(list, index - 1);
+    cursor->node = cursor->prev->next;
   }
+  return SLL_SUCCESS;
+}
+
+int sll_cursor_next(sll_cursor *cursor) {
+  if (!cursor)
+    return SLL_ERR_NULL;
+
+  if (cursor->node == NULL)
+    return SLL_ERR_INDEX;
 
-  Node *at_index = sll_get_at_index(list, index);
-  Node *next_node = sll_get_at_index(list, index + 1);
-  prev_node->next = next_node;
+  cursor->prev = cursor->node;
+  cursor->node = cursor->node->next;
+  cursor->index++;
+  return SLL_SUCCESS;
+}
+
+int sll_cursor_insert_after(sll_cursor *cursor, void *data) {
+  if (!cursor || !data)
+    return SLL_ERR_NULL;
+
+  if (cursor->node == NULL)
+    return SLL_ERR_INDEX;
+
+  List *list = cursor->list;
+  Node *newnode = sll_pool_alloc(list, data);
+  if (newnode == NULL)
+    return SLL_ERR_ALLOC;
+
+  newnode->next = cursor->node->next;
+  cursor->node->next = newnode;
+  if (list->tail == cursor->node)
+    list->tail = newnode;
+
+  list->length++;
+  sll_cache_inserted(list, cursor->index + 1, 1);
+  return SLL_SUCCESS;
+}
+
+/*
+ * Inserts a node before the one under the cursor, which stays on that node.
+ * At the head this prepends and past the end it appends, so a cursor can
+ * also fill an empty list (one freed with sll_free_list, or zeroed).
+ */
+int sll_cursor_insert_before(sll_cursor *cursor, void *data) {
+  if (!cursor || !data)
+    return SLL_ERR_NULL;
+
+  List *list = cursor->list;
+  Node *newnode = sll_pool_alloc(list, data);
+  if (newnode == NULL)
+    return SLL_ERR_ALLOC;
 
-  free(at_index);
+  newnode->next = cursor->node;
+  if (cursor->prev == NULL)
+    list->head = newnode;
+  else
+    cursor->prev->next = newnode;
+  if (cursor->node == NULL)
+    list->tail = newnode;
+
+  list->length++;
+  sll_cache_inserted(list, cursor->index, 1);
+  cursor->prev = newnode;
+  cursor->index++;
+  return SLL_SUCCESS;
+}
+
+int sll_cursor_erase_after(sll_cursor *cursor) {
+  if (!cursor)
+    return SLL_ERR_NULL;
+
+  if (cursor->node == NULL || cursor->node->next == NULL)
+    return SLL_ERR_INDEX;
+
+  List *list = cursor->list;
+  Node *erased = cursor->node->next;
+  cursor->node->next = erased->next;
+  if (list->tail == erased)
+    list->tail = cursor->node;
+
+  sll_pool_release(list, erased);
   list->length--;
+  sll_cache_removed(list, cursor->index + 1);
+  return SLL_SUCCESS;
+}
+
+// Erases the node under the cursor and moves the cursor onto its successor.
+int sll_cursor_erase(sll_cursor *cursor) {
+  if (!cursor)
+    return SLL_ERR_NULL;
+
+  if (cursor->node == NULL)
+    return SLL_ERR_INDEX;
+
+  List *list = cursor->list;
+  Node *erased = cursor->node;
+  if (cursor->prev == NULL)
+    list->head = erased->next;
+  else
+    cursor->prev->next = erased->next;
+  if (list->tail == erased)
+    list->tail = cursor->prev;
+
+  cursor->node = erased->next;
+  sll_pool_release(list, erased);
+  list->length--;
+  sll_cache_removed(list, cursor->index);
+  return SLL_SUCCESS;
+}
+
+/*
+ * Hands every slab of `other` over to `list`, for when nodes move between lists
+ * without being copied, and leaves `other` empty. `other` must be
+ * re-initialised before reuse. Free nodes still cached by `other` are only
+ * kept when `list` has no slabs of its own; otherwise they are released
+ * together with their slab.
+ */
+static void sll_take_slabs(List *list, List *other) {
+  if (list->slabs == NULL) {
+    list->slabs = other->slabs;
+    list->free_nodes = other->free_nodes;
+    list->slab_used = other->slab_used;
+  } else if (other->slabs != NULL) {
+    sll_slab *last = other->slabs;
+    while (last->next != NULL)
+      last = last->next;
+    last->next = list->slabs->next;
+    list->slabs->next = other->slabs;
+  }
+
+  sll_list_reset(other);
+}
+
+/*
+ * Moves every node of `other` in after the cursor without copying them. A
+ * cursor past the end appends them, and is then left on the first of them.
+ */
+int sll_cursor_splice(sll_cursor *cursor, List *other) {
+  if (!cursor || !other)
+    return SLL_ERR_NULL;
+
+  List *list = cursor->list;
+  if (other == list)
+    return SLL_ERR_INDEX;
+
+  if (other->head != NULL && other->length != 0) {
+    if (cursor->node != NULL) {
+      other->tail->next = cursor->node->next;
+      cursor->node->next = other->head;
+      if (list->tail == cursor->node)
+        list->tail = other->tail;
+      sll_cache_inserted(list, cursor->index + 1, other->length);
+    } else {
+      if (cursor->prev == NULL)
+        list->head = other->head;
+      else
+        cursor->prev->next = other->head;
+      list->tail = other->tail;
+      cursor->node = other->head;
+      sll_cache_inserted(list, cursor->index, other->length);
+    }
+    list->length += other->length;
+  }
+
+  sll_take_slabs(list, other);
+  return SLL_SUCCESS;
+}
+
+/*
+ * Merges the two sorted chains `a` and `b`, taking from `a` on ties so that
+ * the sort is stable, and returns the head of the result.
+ */
+static Node *sll_merge_chains(Node *a, Node *b, sll_compare_fn cmp) {
+  Node dummy;
+  Node *tail = &dummy;
+  while (a != NULL && b != NULL) {
+    if (cmp(a->data, b->data) <= 0) {
+      tail->next = a;
+      a = a->next;
+    } else {
+      tail->next = b;
+      b = b->next;
+    }
+    tail = tail->next;
+  }
+
+  tail->next = (a != NULL) ? a : b;
+  return dummy.next;
+}
+
+/*
+ * Sorts the list in place with a merge sort that relinks nodes instead of
+ * copying them and allocates nothing. Nodes are taken off the list one at a
+ * time and carried like a binary counter through `runs`, where runs[i] is
+ * either empty or a sorted run of 2^i nodes, so each merge works on nodes
+ * that were touched recently rather than sweeping the whole list once per
+ * level.
+ */
+#define SLL_SORT_RUNS (sizeof(size_t) * 8)
+
+int sll_sort(List *list, sll_compare_fn cmp) {
+  if (!list || !cmp)
+    return SLL_ERR_NULL;
+
+  if (list->head == NULL || list->length == 0)
+    return SLL_ERR_UNINIT;
+
+  Node *runs[SLL_SORT_RUNS] = {NULL};
+  Node *node = list->head;
+  while (node != NULL) {
+    Node *run = node;
+    node = node->next;
+    run->next = NULL;
+
+    // runs[i] holds nodes from earlier in the list than `run`, so it goes
+    // first to keep the sort stable.
+    size_t i = 0;
+    for (; runs[i] != NULL; i++) {
+      run = sll_merge_chains(runs[i], run, cmp);
+      runs[i] = NULL;
+    }
+    runs[i] = run;
+  }
+
+  Node *sorted = NULL;
+  for (size_t i = 0; i < SLL_SORT_RUNS; i++)
+    if (runs[i] != NULL)
+      sorted = (sorted == NULL) ? runs[i]
+                                : sll_merge_chains(runs[i], sorted, cmp);
+
+  list->head = sorted;
+  Node *tail = list->head;
+  while (tail->next != NULL)
+    tail = tail->next;
+  list->tail = tail;
+  list->cache_node = NULL;
+  return SLL_SUCCESS;
+}
+
+typedef struct sll_merge_entry {
+  Node *node;
+  size_t source;
+} sll_merge_entry;
+
+static int sll_merge_entry_less(sll_merge_entry *a, sll_merge_entry *b,
+                                sll_compare_fn cmp) {
+  int order = cmp(a->node->data, b->node->data);
+  return order < 0 || (order == 0 && a->source < b->source);
+}
+
+static void sll_merge_sift_down(sll_merge_entry *heap, size_t count,
+                                size_t pos, sll_compare_fn cmp) {
+  while (2 * pos + 1 < count) {
+    size_t child = 2 * pos + 1;
+    if (child + 1 < count &&
+        sll_merge_entry_less(&heap[child + 1], &heap[child], cmp))
+      child++;
+    if (!sll_merge_entry_less(&heap[child], &heap[pos], cmp))
+      break;
+
+    sll_merge_entry temp = heap[pos];
+    heap[pos] = heap[child];
+    heap[child] = temp;
+    pos = child;
+  }
+}
+
+/*
+ * Merges `count` sorted lists into `out` with a binary heap over the current
+ * head of each list. Nodes are relinked, never copied, and the slabs backing
+ * them move to `out` as well. Every input list is left empty. `out` may be
+ * one of `lists`; otherwise it is overwritten without being freed, so it must
+ * not hold nodes of its own. Equal elements keep the order of their source
+ * lists.
+ */
+int sll_merge_sorted(List *out, List *lists, size_t count,
+                     sll_compare_fn cmp) {
+  if (!out || !cmp || (!lists && count > 0))
+    return SLL_ERR_NULL;
+
+  sll_merge_entry *heap = malloc((count > 0 ? count : 1) * sizeof(*heap));
+  if (heap == NULL)
+    return SLL_ERR_ALLOC;
+
+  // The merge is built in `merged` and only stored in `out` at the end, as
+  // taking the slabs of `out` when it is one of the inputs empties it.
+  List merged;
+  sll_list_reset(&merged);
+
+  size_t heap_count = 0;
+  size_t length = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (lists[i].head != NULL && lists[i].length != 0) {
+      heap[heap_count].node = lists[i].head;
+      heap[heap_count].source = i;
+      heap_count++;
+      length += lists[i].length;
+    }
+    sll_take_slabs(&merged, &lists[i]);
+  }
+
+  for (size_t i = heap_count / 2; i-- > 0;)
+    sll_merge_sift_down(heap, heap_count, i, cmp);
+
+  Node dummy;
+  Node *tail = &dummy;
+  dummy.next = NULL;
+
+  while (heap_count > 0) {
+    Node *node = heap[0].node;
+    tail->next = node;
+    tail = node;
+
+    if (node->next != NULL) {
+      heap[0].node = node->next;
+    } else {
+      heap_count--;
+      heap[0] = heap[heap_count];
+    }
+    sll_merge_sift_down(heap, heap_count, 0, cmp);
+  }
+
+  free(heap);
+  tail->next = NULL;
+  merged.head = dummy.next;
+  merged.tail = (dummy.next != NULL) ? tail : NULL;
+  merged.length = length;
+  *out = merged;
   return SLL_SUCCESS;
 }
 
@@ -247,12 +671,385 @@ int sll_free_list(List *list) {
   if (!list)
     return SLL_ERR_NULL;
 
-  if (list->head != NULL) {
-    sll_free_chain(list->head);
+  sll_slab *slab = list->slabs;
+  while (slab != NULL) {
+    sll_slab *next = slab->next;
+    free(slab);
+    slab = next;
   }
 
-  list->head = NULL;
-  list->tail = NULL;
-  list->length = 0;
+  sll_list_reset(list);
+  return SLL_SUCCESS;
+}
+
+/*
+ * Copies the list's telemetry counters into `stats`; zero unless built with
+ * DSA_TELEMETRY. They start over whenever the list is initialised, freed or
+ * spliced into another list.
+ */
+int sll_stats_snapshot(List *list, telemetry_stats *stats) {
+  if (!list || !stats)
+    return SLL_ERR_NULL;
+  telemetry_copy(list, stats);
+  return SLL_SUCCESS;
+}
+
+int sll_stats_reset(List *list) {
+  if (!list)
+    return SLL_ERR_NULL;
+  telemetry_clear(list);
+  return SLL_SUCCESS;
+}
+
+/*
+ * A skip list keeps express lanes over the Node chain of a List. Level 0 is
+ * the chain itself; a node promoted to level `h` gets a tower holding one link
+ * per level 1..h-1, and every link records how many base nodes it skips so
+ * that lookups by index are expected O(log n) as well as lookups by key. A
+ * node is promoted one more level with probability 1 / `branching`.
+ *
+ * All changes must go through the sll_skip_* functions; `list` can be read
+ * with the plain List functions but not modified through them.
+ */
+#define SLL_SKIP_MAX_LEVELS 32
+
+static sll_skip_tower *sll_skip_create_tower(sll_skip_list *skip, Node *base,
+                                             size_t height) {
+  size_t bytes = sizeof(sll_skip_tower) + (height - 1) * sizeof(sll_skip_link);
+  sll_skip_tower *tower = malloc(bytes);
+  if (tower == NULL)
+    return NULL;
+
+  tower->base = base;
+  tower->height = height;
+  for (size_t lvl = 1; lvl < height; lvl++) {
+    tower->links[lvl - 1].next = NULL;
+    tower->links[lvl - 1].span = 0;
+  }
+  skip->tower_bytes += bytes;
+  return tower;
+}
+
+static void sll_skip_free_tower(sll_skip_list *skip, sll_skip_tower *tower) {
+  skip->tower_bytes -=
+      sizeof(sll_skip_tower) + (tower->height - 1) * sizeof(sll_skip_link);
+  free(tower);
+}
+
+static size_t sll_skip_random_height(sll_skip_list *skip) {
+  size_t height = 1;
+  while (height < skip->max_levels) {
+    // xorshift64
+    skip->seed ^= skip->seed << 13;
+    skip->seed ^= skip->seed >> 7;
+    skip->seed ^= skip->seed << 17;
+    if (skip->seed % skip->branching != 0)
+      break;
+    height++;
+  }
+  return height;
+}
+
+/*
+ * `max_levels` caps the tower height (0 picks SLL_SKIP_MAX_LEVELS) and
+ * `branching` sets the level distribution (0 picks 4). `cmp` orders the data
+ * for the keyed functions and may be NULL when only indexes are used.
+ */
+int sll_skip_init(sll_skip_list *skip, size_t max_levels,
+                  unsigned int branching, sll_compare_fn cmp) {
+  if (!skip)
+    return SLL_ERR_NULL;
+
+  if (max_levels == 0 || max_levels > SLL_SKIP_MAX_LEVELS)
+    max_levels = SLL_SKIP_MAX_LEVELS;
+  if (branching < 2)
+    branching = 4;
+
+  sll_list_reset(&skip->list);
+  skip->levels = 1;
+  skip->max_levels = max_levels;
+  skip->branching = branching;
+  skip->seed = 0x9E3779B97F4A7C15ULL;
+  skip->tower_bytes = 0;
+  skip->cmp = cmp;
+  skip->header = sll_skip_create_tower(skip, NULL, max_levels);
+  if (skip->header == NULL)
+    return SLL_ERR_ALLOC;
+
+  return SLL_SUCCESS;
+}
+
+/*
+ * Descends the express lanes towards the node with 1-based rank `rank`,
+ * recording the last tower visited on each level in `update` and its rank in
+ * `ranks`, then walks the base chain to the node just before it. Returns that
+ * predecessor, or NULL when `rank` is 1.
+ */
+static Node *sll_skip_descend(sll_skip_list *skip, size_t rank,
+                              sll_skip_tower **update, size_t *ranks) {
+  sll_skip_tower *tower = skip->header;
+  size_t pos = 0;
+
+  for (size_t lvl = skip->levels; lvl-- > 1;) {
+    sll_skip_link *link = &tower->links[lvl - 1];
+    while (link->next != NULL && pos + link->span < rank) {
+      pos += link->span;
+      tower = link->next;
+      link = &tower->links[lvl - 1];
+    }
+    update[lvl] = tower;
+    ranks[lvl] = pos;
+  }
+
+  Node *node = tower->base;
+  while (pos + 1 < rank) {
+    node = (node == NULL) ? skip->list.head : node->next;
+    pos++;
+  }
+  return node;
+}
+
+// Counts the nodes ordered before `key`, or not after it when `upper` is set.
+static size_t sll_skip_key_rank(sll_skip_list *skip, const void *key,
+                                int upper) {
+  sll_skip_tower *tower = skip->header;
+  size_t pos = 0;
+
+  for (size_t lvl = skip->levels; lvl-- > 1;) {
+    sll_skip_link *link = &tower->links[lvl - 1];
+    while (link->next != NULL) {
+      int order = skip->cmp(link->next->base->data, key);
+      if (order > 0 || (order == 0 && !upper))
+        break;
+      pos += link->span;
+      tower = link->next;
+      link = &tower->links[lvl - 1];
+    }
+  }
+
+  Node *node = (tower->base == NULL) ? skip->list.head : tower->base->next;
+  while (node != NULL) {
+    int order = skip->cmp(node->data, key);
+    if (order > 0 || (order == 0 && !upper))
+      break;
+    pos++;
+    node = node->next;
+  }
+  return pos;
+}
+
+Node *sll_skip_get_at_index(sll_skip_list *skip, size_t index) {
+  if (!skip || index >= skip->list.length)
+    return NULL;
+
+  sll_skip_tower *update[SLL_SKIP_MAX_LEVELS];
+  size_t ranks[SLL_SKIP_MAX_LEVELS];
+  Node *prev = sll_skip_descend(skip, index + 1, update, ranks);
+  return (prev == NULL) ? skip->list.head : prev->next;
+}
+
+int sll_skip_insert_at(sll_skip_list *skip, size_t index, void *data) {
+  if (!skip || !data)
+    return SLL_ERR_NULL;
+
+  if (skip->header == NULL)
+    return SLL_ERR_UNINIT;
+
+  List *list = &skip->list;
+  if (index > list->length)
+    return SLL_ERR_INDEX;
+
+  sll_skip_tower *update[SLL_SKIP_MAX_LEVELS];
+  size_t ranks[SLL_SKIP_MAX_LEVELS];
+  Node *prev = sll_skip_descend(skip, index + 1, update, ranks);
+
+  Node *node = sll_pool_alloc(list, data);
+  if (node == NULL)
+    return SLL_ERR_ALLOC;
+
+  size_t height = sll_skip_random_height(skip);
+  sll_skip_tower *tower = NULL;
+  if (height > 1) {
+    tower = sll_skip_create_tower(skip, node, height);
+    if (tower == NULL) {
+      sll_pool_release(list, node);
+      return SLL_ERR_ALLOC;
+    }
+  }
+
+  if (prev == NULL) {
+    node->next = list->head;
+    list->head = node;
+  } else {
+    node->next = prev->next;
+    prev->next = node;
+  }
+  if (node->next == NULL)
+    list->tail = node;
+
+  for (size_t lvl = skip->levels; lvl < height; lvl++) {
+    update[lvl] = skip->header;
+    ranks[lvl] = 0;
+    skip->header->links[lvl - 1].next = NULL;
+    skip->header->links[lvl - 1].span = list->length;
+  }
+  if (height > skip->levels)
+    skip->levels = height;
+
+  for (size_t lvl = 1; lvl < skip->levels; lvl++) {
+    sll_skip_link *link = &update[lvl]->links[lvl - 1];
+    if (lvl < height) {
+      size_t before = index - ranks[lvl];
+      tower->links[lvl - 1].next = link->next;
+      tower->links[lvl - 1].span = link->span - before;
+      link->next = tower;
+      link->span = before + 1;
+    } else {
+      link->span++;
+    }
+  }
+
+  list->length++;
+  list->cache_node = NULL;
   return SLL_SUCCESS;
 }
+
+int sll_skip_delete_at(sll_skip_list *skip, size_t index) {
+  if (!skip)
+    return SLL_ERR_NULL;
+
+  List *list = &skip->list;
+  if (skip->header == NULL || list->head == NULL || list->length == 0)
+    return SLL_ERR_UNINIT;
+
+  if (index >= list->length)
+    return SLL_ERR_INDEX;
+
+  sll_skip_tower *update[SLL_SKIP_MAX_LEVELS];
+  size_t ranks[SLL_SKIP_MAX_LEVELS];
+  Node *prev = sll_skip_descend(skip, index + 1, update, ranks);
+  Node *node = (prev == NULL) ? list->head : prev->next;
+
+  sll_skip_tower *tower = NULL;
+  for (size_t lvl = 1; lvl < skip->levels; lvl++) {
+    sll_skip_link *link = &update[lvl]->links[lvl - 1];
+    if (link->next != NULL && link->next->base == node) {
+      tower = link->next;
+      link->span += tower->links[lvl - 1].span - 1;
+      link->next = tower->links[lvl - 1].next;
+    } else {
+      link->span--;
+    }
+  }
+  if (tower != NULL)
+    sll_skip_free_tower(skip, tower);
+
+  while (skip->levels > 1 &&
+         skip->header->links[skip->levels - 2].next == NULL)
+    skip->levels--;
+
+  if (prev == NULL)
+    list->head = node->next;
+  else
+    prev->next = node->next;
+  if (list->tail == node)
+    list->tail = prev;
+
+  sll_pool_release(list, node);
+  list->length--;
+  list->cache_node = NULL;
+  return SLL_SUCCESS;
+}
+
+// Index of the first node not ordered before `key`, i.e. its lower bound.
+int sll_skip_rank(sll_skip_list *skip, const void *key, size_t *index) {
+  if (!skip || !key || !index)
+    return SLL_ERR_NULL;
+
+  if (skip->header == NULL || skip->cmp == NULL)
+    return SLL_ERR_UNINIT;
+
+  *index = sll_skip_key_rank(skip, key, 0);
+  return SLL_SUCCESS;
+}
+
+Node *sll_skip_find(sll_skip_list *skip, const void *key) {
+  size_t index;
+  if (sll_skip_rank(skip, key, &index) != SLL_SUCCESS)
+    return NULL;
+
+  Node *node = sll_skip_get_at_index(skip, index);
+  if (node == NULL || skip->cmp(node->data, key) != 0)
+    return NULL;
+  return node;
+}
+
+// Inserts `data` in key order, after any nodes that compare equal to it.
+int sll_skip_insert(sll_skip_list *skip, void *data) {
+  if (!skip || !data)
+    return SLL_ERR_NULL;
+
+  if (skip->header == NULL || skip->cmp == NULL)
+    return SLL_ERR_UNINIT;
+
+  return sll_skip_insert_at(skip, sll_skip_key_rank(skip, data, 1), data);
+}
+
+// Deletes the first node that compares equal to `key`.
+int sll_skip_delete(sll_skip_list *skip, const void *key) {
+  size_t index;
+  int result = sll_skip_rank(skip, key, &index);
+  if (result != SLL_SUCCESS)
+    return result;
+
+  Node *node = sll_skip_get_at_index(skip, index);
+  if (node == NULL || skip->cmp(node->data, key) != 0)
+    return SLL_ERR_INDEX;
+  return sll_skip_delete_at(skip, index);
+}
+
+/*
+ * Reports the memory spent on express lanes (towers and the header) on top of
+ * the base chain, in total and averaged over the nodes in the list.
+ */
+int sll_skip_memory_overhead(sll_skip_list *skip, size_t *bytes,
+                             double *bytes_per_node) {
+  if (!skip)
+    return SLL_ERR_NULL;
+
+  if (bytes)
+    *bytes = skip->tower_bytes;
+  if (bytes_per_node)
+    *bytes_per_node = (skip->list.length == 0)
+                          ? 0.0
+                          : (double)skip->tower_bytes / skip->list.length;
+  return SLL_SUCCESS;
+}
+
+int sll_skip_free(sll_skip_list *skip) {
+  if (!skip)
+    return SLL_ERR_NULL;
+
+  if (skip->header != NULL) {
+    sll_skip_tower *tower = skip->header;
+    while (tower != NULL) {
+      sll_skip_tower *next =
+          (tower->height > 1) ? tower->links[0].next : NULL;
+      free(tower);
+      tower = next;
+    }
+  }
+
+  sll_free_list(&skip->list);
+  skip->header = NULL;
+  skip->levels = 1;
+  skip->tower_bytes = 0;
+  return SLL_SUCCESS;
+}
+
+#undef SLL_SKIP_MAX_LEVELS
+#undef SLL_SORT_RUNS
+#undef SLL_SLAB_NODES
+#undef SLL_SLAB_HEADER
+#undef SLL_SLAB_SIZE
+#undef SLL_CACHE_LINE
@@ -0,0 +1,125 @@
+/*
+ * @file: singly_linked_list.h
+ * @brief: Declares the singly linked list, its cursors and skip-list index,
+ * and their functions.
+ */
+
+#ifndef SINGLY_LINKED_LIST_H
+#define SINGLY_LINKED_LIST_H
+
+#include <stddef.h>
+
+#include "telemetry.h"
+
+enum sll_errors {
+  SLL_SUCCESS = 0,
+  SLL_ERR_NULL,
+  SLL_ERR_INDEX,
+  SLL_ERR_UNINIT,
+  SLL_ERR_ALLOC
+};
+
+typedef struct Node {
+  void *data;
+  struct Node *next;
+} Node;
+
+typedef struct sll_slab {
+  struct sll_slab *next;
+} sll_slab;
+
+typedef struct List {
+  Node *head;
+  Node *tail;
+  size_t length;
+  sll_slab *slabs;
+  Node *free_nodes;
+  size_t slab_used;
+  Node *cache_node;
+  size_t cache_index;
+#ifdef DSA_TELEMETRY
+  telemetry_stats stats;
+#endif
+} List;
+
+/*
+ * A cursor walks the list while remembering the node before it, so inserting
+ * or erasing at the cursor is O(1) and a full editing pass is O(n). At the end
+ * of the list `node` is NULL and `prev` is the tail, and on an empty list both
+ * are NULL. Changing the list through anything other than the cursor itself
+ * invalidates it.
+ */
+typedef struct sll_cursor {
+  List *list;
+  Node *prev;
+  Node *node;
+  size_t index;
+} sll_cursor;
+
+typedef int (*sll_compare_fn)(const void *a, const void *b);
+
+typedef struct sll_skip_tower sll_skip_tower;
+
+typedef struct sll_skip_link {
+  sll_skip_tower *next;
+  size_t span;
+} sll_skip_link;
+
+struct sll_skip_tower {
+  Node *base;
+  size_t height;
+  sll_skip_link links[]; // links[lvl - 1] is the link at level lvl
+};
+
+typedef struct sll_skip_list {
+  List list;
+  sll_skip_tower *header;
+  size_t levels;
+  size_t max_levels;
+  unsigned int branching;
+  unsigned long long seed;
+  size_t tower_bytes;
+  sll_compare_fn cmp;
+} sll_skip_list;
+
+char *sll_get_error_string(enum sll_errors error);
+Node *sll_create_node(void *data);
+int sll_list_init(List *list, void *data);
+Node *sll_get_at_index(List *list, size_t index);
+int sll_prepend_node(List *list, void *data);
+int sll_append_node(List *list, void *data);
+int sll_insert_node(List *list, size_t index, void *data);
+int sll_delete_head(List *list);
+int sll_delete_tail(List *list);
+int sll_delete_at_index(List *list, size_t index);
+int sll_cursor_init(sll_cursor *cursor, List *list);
+int sll_cursor_seek(sll_cursor *cursor, List *list, size_t index);
+int sll_cursor_next(sll_cursor *cursor);
+int sll_cursor_insert_after(sll_cursor *cursor, void *data);
+int sll_cursor_insert_before(sll_cursor *cursor, void *data);
+int sll_cursor_erase_after(sll_cursor *cursor);
+int sll_cursor_erase(sll_cursor *cursor);
+int sll_cursor_splice(sll_cursor *cursor, List *other);
+int sll_sort(List *list, sll_compare_fn cmp);
+// Empties every list in `lists` into `out`, which may be one of them but
+// otherwise must not hold any nodes, as its old contents are overwritten.
+int sll_merge_sorted(List *out, List *lists, size_t count,
+                     sll_compare_fn cmp);
+int sll_free_chain(Node *node);
+int sll_free_list(List *list);
+int sll_stats_snapshot(List *list, telemetry_stats *stats);
+int sll_stats_reset(List *list);
+int sll_skip_init(sll_skip_list *skip, size_t max_levels,
+                  unsigned int branching, sll_compare_fn cmp);
+Node *sll_skip_get_at_index(sll_skip_list *skip, size_t index);
+int sll_skip_insert_at(sll_skip_list *skip, size_t index, void *data);
+int sll_skip_delete_at(sll_skip_list *skip, size_t index);
+int sll_skip_rank(sll_skip_list *skip, const void *key, size_t *index);
+Node *sll_skip_find(sll_skip_list *skip, const void *key);
+int sll_skip_insert(sll_skip_list *skip, void *data);
+int sll_skip_delete(sll_skip_list *skip, const void *key);
+int sll_skip_memory_overhead(sll_skip_list *skip, size_t *bytes,
+                             double *bytes_per_node);
+int sll_skip_free(sll_skip_list *skip);
+
+#endif /* ifndef SINGLY_LINKED_LIST_H */
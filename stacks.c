@@ -1,20 +1,13 @@
 /*
  * @file: stacks.c
- * @brief: Implements a stack data type, built on top of a dynamic array.
+ * @brief: Implements a stack data type, built on top of a dynamic array, and
+ * a segmented stack built on a segmented array.
  */
 
 #include <stdlib.h>
 #include <string.h>
 
-enum stack_errors {
-  STACK_SUCCESS = 0,
-  STACK_ERR_NULL,
-  STACK_ERR_INDEX,
-  STACK_ERR_UNINIT,
-  STACK_ERR_ALLOC,
-  STACK_ERR_RESIZE,
-  STACK_ERR_EMPTY
-};
+#include "stacks.h"
 
 char *stack_get_error_string(enum stack_errors error) {
   switch (error) {
@@ -37,15 +30,11 @@ char *stack_get_error_string(enum stack_errors error) {
   }
 }
 
-typedef struct stack {
-  void *items;
-  size_t item_size;
-  size_t count;
-  size_t capacity;
-} stack;
-
 #define STACK_INITIAL_CAPACITY 4
 #define STACK_RESIZE_FACTOR 2
+// Shrink only once the stack is a quarter full, so a pop right after an
+// expand doesn't give the memory straight back.
+#define STACK_SHRINK_THRESHOLD 4
 
 int stack_init(stack *s, size_t item_size) {
   if (!s)
@@ -58,6 +47,11 @@ int stack_init(stack *s, size_t item_size) {
     return STACK_ERR_ALLOC;
   }
   s->count = 0;
+  telemetry_clear(s);
+  telemetry_add(s, TELEMETRY_STACK, allocations, 1);
+  telemetry_add(s, TELEMETRY_STACK, bytes_allocated,
+                s->item_size * s->capacity);
+  telemetry_peak(s, TELEMETRY_STACK, peak_capacity, s->capacity);
   return STACK_SUCCESS;
 }
 
@@ -70,6 +64,9 @@ int stack_expand(stack *s) {
   void *new_items = realloc(s->items, s->item_size * new_capacity);
   if (!new_items)
     return STACK_ERR_ALLOC;
+  telemetry_resize(s, TELEMETRY_STACK, grows, s->item_size * new_capacity,
+                   (new_items != s->items) ? s->item_size * s->capacity : 0,
+                   new_capacity);
   s->items = new_items;
   s->capacity = new_capacity;
   return STACK_SUCCESS;
@@ -87,6 +84,9 @@ int stack_shrink(stack *s) {
   void *new_items = realloc(s->items, new_capacity * s->item_size);
   if (new_items == NULL)
     return STACK_ERR_ALLOC;
+  telemetry_resize(s, TELEMETRY_STACK, shrinks, new_capacity * s->item_size,
+                   (new_items != s->items) ? new_capacity * s->item_size : 0,
+                   new_capacity);
   s->items = new_items;
   s->capacity = new_capacity;
   return STACK_SUCCESS;
@@ -122,7 +122,7 @@ int stack_pop(stack *s, void *item) {
          s->item_size);
   s->count--;
 
-  if (s->count < (s->capacity / STACK_RESIZE_FACTOR))
+  if (s->count < (s->capacity / STACK_SHRINK_THRESHOLD))
     if (stack_shrink(s) != 0)
       return STACK_ERR_RESIZE;
 
@@ -139,5 +139,86 @@ void stack_free(stack *s) {
   s->capacity = 0;
 }
 
+// Copies the stack's telemetry counters into `stats`; zero unless built with
+// DSA_TELEMETRY.
+int stack_stats_snapshot(stack *s, telemetry_stats *stats) {
+  if (!s || !stats)
+    return STACK_ERR_NULL;
+  telemetry_copy(s, stats);
+  return STACK_SUCCESS;
+}
+
+int stack_stats_reset(stack *s) {
+  if (!s)
+    return STACK_ERR_NULL;
+  telemetry_clear(s);
+  return STACK_SUCCESS;
+}
+
+/*
+ * A segmented stack is a segmented_array used from its end only, so it has
+ * the same growth (one more never-moving segment per push that overflows) and
+ * the same hysteresis when popping back across a segment boundary.
+ */
+static int sstack_error(int error) {
+  switch (error) {
+  case DA_SUCCESS:
+    return STACK_SUCCESS;
+  case DA_ERR_NULL:
+    return STACK_ERR_NULL;
+  case DA_ERR_INDEX:
+    return STACK_ERR_INDEX;
+  case DA_ERR_UNINIT:
+    return STACK_ERR_UNINIT;
+  case DA_ERR_ALLOC:
+    return STACK_ERR_ALLOC;
+  case DA_ERR_RESIZE:
+    return STACK_ERR_RESIZE;
+  case DA_ERR_EMPTY:
+    return STACK_ERR_EMPTY;
+  default:
+    return STACK_ERR_UNINIT;
+  }
+}
+
+int sstack_init(segmented_stack *s, size_t item_size) {
+  if (!s)
+    return STACK_ERR_NULL;
+  return sstack_error(sa_init(&s->items, item_size));
+}
+
+int sstack_push(segmented_stack *s, void *item) {
+  if (!s || !item)
+    return STACK_ERR_NULL;
+  return sstack_error(sa_push(&s->items, item));
+}
+
+// `item` may be NULL to just drop the top item.
+int sstack_pop(segmented_stack *s, void *item) {
+  if (!s)
+    return STACK_ERR_NULL;
+  return sstack_error(sa_pop_item(&s->items, item));
+}
+
+int sstack_peek(segmented_stack *s, void *item) {
+  if (!s || !item)
+    return STACK_ERR_NULL;
+
+  if (s->items.item_size == 0)
+    return STACK_ERR_UNINIT;
+
+  if (s->items.count == 0)
+    return STACK_ERR_EMPTY;
+
+  return sstack_error(sa_get_item(&s->items, s->items.count - 1, item));
+}
+
+void sstack_free(segmented_stack *s) {
+  if (!s)
+    return;
+  sa_free(&s->items);
+}
+
+#undef STACK_SHRINK_THRESHOLD
 #undef STACK_INITIAL_CAPACITY
 #undef STACK_RESIZE_FACTOR
@@ -0,0 +1,53 @@
+/*
+ * @file: stacks.h
+ * @brief: Declares the stack and segmented stack types and their functions.
+ */
+
+#ifndef STACKS_H
+#define STACKS_H
+
+#include <stddef.h>
+
+#include "dynamic_array.h"
+#include "telemetry.h"
+
+enum stack_errors {
+  STACK_SUCCESS = 0,
+  STACK_ERR_NULL,
+  STACK_ERR_INDEX,
+  STACK_ERR_UNINIT,
+  STACK_ERR_ALLOC,
+  STACK_ERR_RESIZE,
+  STACK_ERR_EMPTY
+};
+
+typedef struct stack {
+  void *items;
+  size_t item_size;
+  size_t count;
+  size_t capacity;
+#ifdef DSA_TELEMETRY
+  telemetry_stats stats;
+#endif
+} stack;
+
+typedef struct segmented_stack {
+  segmented_array items;
+} segmented_stack;
+
+char *stack_get_error_string(enum stack_errors error);
+int stack_init(stack *s, size_t item_size);
+int stack_expand(stack *s);
+int stack_shrink(stack *s);
+int stack_push(stack *s, void *item);
+int stack_pop(stack *s, void *item);
+void stack_free(stack *s);
+int stack_stats_snapshot(stack *s, telemetry_stats *stats);
+int stack_stats_reset(stack *s);
+int sstack_init(segmented_stack *s, size_t item_size);
+int sstack_push(segmented_stack *s, void *item);
+int sstack_pop(segmented_stack *s, void *item);
+int sstack_peek(segmented_stack *s, void *item);
+void sstack_free(segmented_stack *s);
+
+#endif /* ifndef STACKS_H */
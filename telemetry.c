@@ -0,0 +1,88 @@
+/*
+ * @file: telemetry.c
+ * @brief: Implements the global side of the container telemetry: counters
+ * summed over every container of a kind, and snapshots of them.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+char *telemetry_get_error_string(enum telemetry_errors error) {
+  switch (error) {
+  case TELEMETRY_SUCCESS:
+    return "SUCCESS";
+  case TELEMETRY_ERR_NULL:
+    return "NULL_PARAMETER";
+  case TELEMETRY_ERR_KIND:
+    return "UNKNOWN_KIND";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+#define TELEMETRY_FIELDS (sizeof(telemetry_stats) / sizeof(uint64_t))
+
+#ifdef DSA_TELEMETRY
+
+/*
+ * Containers of the same kind may be used from different threads, so the
+ * global counters are atomics. They are only ever added to with relaxed
+ * ordering, which is all a counter needs; a snapshot is therefore not taken
+ * at a single instant across fields.
+ */
+static _Atomic uint64_t telemetry_global[TELEMETRY_KINDS][TELEMETRY_FIELDS];
+
+void telemetry_record(telemetry_stats *local, enum telemetry_kind kind,
+                      size_t field, uint64_t n) {
+  ((uint64_t *)local)[field] += n;
+  atomic_fetch_add_explicit(&telemetry_global[kind][field], n,
+                            memory_order_relaxed);
+}
+
+void telemetry_record_peak(telemetry_stats *local, enum telemetry_kind kind,
+                           size_t field, uint64_t n) {
+  uint64_t *counter = (uint64_t *)local + field;
+  if (*counter < n)
+    *counter = n;
+
+  _Atomic uint64_t *global = &telemetry_global[kind][field];
+  uint64_t old = atomic_load_explicit(global, memory_order_relaxed);
+  while (old < n && !atomic_compare_exchange_weak_explicit(
+                        global, &old, n, memory_order_relaxed,
+                        memory_order_relaxed))
+    ;
+}
+
+#endif /* ifdef DSA_TELEMETRY */
+
+// Copies the counters summed over every container of `kind` into `stats`.
+int telemetry_snapshot(enum telemetry_kind kind, telemetry_stats *stats) {
+  if (!stats)
+    return TELEMETRY_ERR_NULL;
+  if ((unsigned)kind >= TELEMETRY_KINDS)
+    return TELEMETRY_ERR_KIND;
+
+  memset(stats, 0, sizeof(*stats));
+#ifdef DSA_TELEMETRY
+  for (size_t i = 0; i < TELEMETRY_FIELDS; i++)
+    ((uint64_t *)stats)[i] =
+        atomic_load_explicit(&telemetry_global[kind][i], memory_order_relaxed);
+#endif
+  return TELEMETRY_SUCCESS;
+}
+
+int telemetry_reset(enum telemetry_kind kind) {
+  if ((unsigned)kind >= TELEMETRY_KINDS)
+    return TELEMETRY_ERR_KIND;
+
+#ifdef DSA_TELEMETRY
+  for (size_t i = 0; i < TELEMETRY_FIELDS; i++)
+    atomic_store_explicit(&telemetry_global[kind][i], 0, memory_order_relaxed);
+#endif
+  return TELEMETRY_SUCCESS;
+}
+
+#undef TELEMETRY_FIELDS
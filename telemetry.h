@@ -0,0 +1,93 @@
+/*
+ * @file: telemetry.h
+ * @brief: Declares optional counters for allocations, copies and traversals
+ * inside dynamic_array, stack and List, kept per container and globally.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum telemetry_errors {
+  TELEMETRY_SUCCESS = 0,
+  TELEMETRY_ERR_NULL,
+  TELEMETRY_ERR_KIND
+};
+
+enum telemetry_kind {
+  TELEMETRY_DYNAMIC_ARRAY = 0,
+  TELEMETRY_STACK,
+  TELEMETRY_LIST,
+  TELEMETRY_KINDS
+};
+
+/*
+ * Every field is a uint64_t so the global counters can be kept as a plain
+ * array indexed by field. peak_capacity is the largest capacity reached, in
+ * items; for List it is the most nodes in use at once. node_hops divided by
+ * traversals is the average walk length of an index lookup.
+ */
+typedef struct telemetry_stats {
+  uint64_t allocations;
+  uint64_t bytes_allocated;
+  uint64_t bytes_copied;
+  uint64_t grows;
+  uint64_t shrinks;
+  uint64_t peak_capacity;
+  uint64_t traversals;
+  uint64_t node_hops;
+  uint64_t memmove_bytes;
+} telemetry_stats;
+
+/*
+ * Counting is compiled in only with -DDSA_TELEMETRY, which must then be used
+ * for every file of the library and its users since it adds a `stats` member
+ * to the containers. Without it the macros below expand to nothing and
+ * snapshots read as all zero.
+ */
+#ifdef DSA_TELEMETRY
+
+#define telemetry_clear(owner)                                                 \
+  memset(&(owner)->stats, 0, sizeof((owner)->stats))
+#define telemetry_copy(owner, out) (*(out) = (owner)->stats)
+#define telemetry_add(owner, kind, field, n)                                   \
+  telemetry_record(&(owner)->stats, (kind),                                    \
+                   offsetof(telemetry_stats, field) / sizeof(uint64_t), (n))
+#define telemetry_peak(owner, kind, field, n)                                  \
+  telemetry_record_peak(&(owner)->stats, (kind),                               \
+                        offsetof(telemetry_stats, field) / sizeof(uint64_t),   \
+                        (n))
+// One (re)allocation of `bytes` that left `capacity` items, copying `copied`
+// bytes if the block moved.
+#define telemetry_resize(owner, kind, field, bytes, copied, capacity)          \
+  do {                                                                         \
+    telemetry_add(owner, kind, allocations, 1);                                \
+    telemetry_add(owner, kind, bytes_allocated, (bytes));                      \
+    telemetry_add(owner, kind, bytes_copied, (copied));                        \
+    telemetry_add(owner, kind, field, 1);                                      \
+    telemetry_peak(owner, kind, peak_capacity, (capacity));                    \
+  } while (0)
+
+void telemetry_record(telemetry_stats *local, enum telemetry_kind kind,
+                      size_t field, uint64_t n);
+void telemetry_record_peak(telemetry_stats *local, enum telemetry_kind kind,
+                           size_t field, uint64_t n);
+
+#else
+
+#define telemetry_clear(owner) ((void)0)
+#define telemetry_copy(owner, out) memset((out), 0, sizeof(telemetry_stats))
+#define telemetry_add(owner, kind, field, n) ((void)0)
+#define telemetry_peak(owner, kind, field, n) ((void)0)
+#define telemetry_resize(owner, kind, field, bytes, copied, capacity) ((void)0)
+
+#endif /* ifdef DSA_TELEMETRY */
+
+char *telemetry_get_error_string(enum telemetry_errors error);
+int telemetry_snapshot(enum telemetry_kind kind, telemetry_stats *stats);
+int telemetry_reset(enum telemetry_kind kind);
+
+#endif /* ifndef TELEMETRY_H */
@@ -0,0 +1,342 @@
+/*
+ * @file: unrolled_linked_list.c
+ * @brief: Implements an unrolled linked list, where every node stores several
+ * fixed size items inline so that scans touch far fewer cache lines than a
+ * node-per-item list.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unrolled_linked_list.h"
+
+char *ull_get_error_string(enum ull_errors error) {
+  switch (error) {
+  case ULL_SUCCESS:
+    return "SUCCESS";
+  case ULL_ERR_NULL:
+    return "NULL_PARAMETER";
+  case ULL_ERR_INDEX:
+    return "INDEX_ERROR";
+  case ULL_ERR_UNINIT:
+    return "UNINITIALIZED";
+  case ULL_ERR_ALLOC:
+    return "ALLOCATION_ERROR";
+  case ULL_ERR_EMPTY:
+    return "LIST_EMPTY";
+  default:
+    return "UNKNOWN_ERROR";
+  }
+}
+
+/*
+ * A node is sized to fill ULL_NODE_BYTES (two cache lines) including its
+ * header, but always holds at least ULL_MIN_CAPACITY items, growing by whole
+ * cache lines for large items, so that the halves of a split node are still
+ * worth a node each.
+ */
+#define ULL_CACHE_LINE 64
+#define ULL_NODE_BYTES 128
+#define ULL_MIN_CAPACITY 8
+
+#define ull_item(list, node, pos)                                              \
+  ((node)->items + ((pos) * (list)->item_size))
+
+int ull_init(unrolled_list *list, size_t item_size) {
+  if (!list)
+    return ULL_ERR_NULL;
+  if (item_size == 0)
+    return ULL_ERR_UNINIT;
+
+  size_t capacity = (ULL_NODE_BYTES - sizeof(ull_node)) / item_size;
+  if (capacity < ULL_MIN_CAPACITY)
+    capacity = ULL_MIN_CAPACITY;
+
+  if (item_size > (SIZE_MAX - sizeof(ull_node) - ULL_CACHE_LINE) / capacity)
+    return ULL_ERR_ALLOC;
+
+  // Whatever the rounding up to a cache line leaves over holds more items.
+  size_t bytes = sizeof(ull_node) + capacity * item_size;
+  bytes = (bytes + ULL_CACHE_LINE - 1) / ULL_CACHE_LINE * ULL_CACHE_LINE;
+  capacity = (bytes - sizeof(ull_node)) / item_size;
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->item_size = item_size;
+  list->node_capacity = capacity;
+  list->node_bytes = bytes;
+  list->length = 0;
+  return ULL_SUCCESS;
+}
+
+static ull_node *ull_create_node(unrolled_list *list) {
+  ull_node *node = aligned_alloc(ULL_CACHE_LINE, list->node_bytes);
+  if (node == NULL)
+    return NULL;
+  node->next = NULL;
+  node->count = 0;
+  return node;
+}
+
+/*
+ * Finds the node holding `index` and the position of the item inside it. When
+ * `prev` is given it receives the node before the returned one.
+ */
+static ull_node *ull_find(unrolled_list *list, size_t index, size_t *pos,
+                          ull_node **prev) {
+  ull_node *before = NULL;
+  ull_node *node = list->head;
+
+  while (node != NULL && index >= node->count) {
+    index -= node->count;
+    before = node;
+    node = node->next;
+  }
+
+  *pos = index;
+  if (prev)
+    *prev = before;
+  return node;
+}
+
+int ull_get_item(unrolled_list *list, size_t index, void *item) {
+  if (!list || !item)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+  if (index >= list->length)
+    return ULL_ERR_INDEX;
+
+  size_t pos;
+  ull_node *node = ull_find(list, index, &pos, NULL);
+  memcpy(item, ull_item(list, node, pos), list->item_size);
+  return ULL_SUCCESS;
+}
+
+int ull_set_item(unrolled_list *list, size_t index, void *item) {
+  if (!list || !item)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+  if (index >= list->length)
+    return ULL_ERR_INDEX;
+
+  size_t pos;
+  ull_node *node = ull_find(list, index, &pos, NULL);
+  memcpy(ull_item(list, node, pos), item, list->item_size);
+  return ULL_SUCCESS;
+}
+
+int ull_append_item(unrolled_list *list, void *item) {
+  if (!list || !item)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+
+  // Appends fill the tail node completely instead of splitting it, so a list
+  // built by appending is fully packed.
+  if (list->tail == NULL || list->tail->count == list->node_capacity) {
+    ull_node *node = ull_create_node(list);
+    if (node == NULL)
+      return ULL_ERR_ALLOC;
+    if (list->tail == NULL)
+      list->head = node;
+    else
+      list->tail->next = node;
+    list->tail = node;
+  }
+
+  memcpy(ull_item(list, list->tail, list->tail->count), item, list->item_size);
+  list->tail->count++;
+  list->length++;
+  return ULL_SUCCESS;
+}
+
+int ull_insert_item(unrolled_list *list, size_t index, void *item) {
+  if (!list || !item)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+  if (index > list->length)
+    return ULL_ERR_INDEX;
+
+  if (index == list->length)
+    return ull_append_item(list, item);
+
+  size_t pos;
+  ull_node *node = ull_find(list, index, &pos, NULL);
+
+  if (node->count == list->node_capacity) {
+    // Split: the upper half of the full node moves into a new node after it.
+    ull_node *upper = ull_create_node(list);
+    if (upper == NULL)
+      return ULL_ERR_ALLOC;
+
+    size_t keep = node->count / 2;
+    upper->count = node->count - keep;
+    memcpy(upper->items, ull_item(list, node, keep),
+           upper->count * list->item_size);
+    node->count = keep;
+
+    upper->next = node->next;
+    node->next = upper;
+    if (list->tail == node)
+      list->tail = upper;
+
+    if (pos > keep) {
+      node = upper;
+      pos -= keep;
+    }
+  }
+
+  memmove(ull_item(list, node, pos + 1), ull_item(list, node, pos),
+          (node->count - pos) * list->item_size);
+  memcpy(ull_item(list, node, pos), item, list->item_size);
+  node->count++;
+  list->length++;
+  return ULL_SUCCESS;
+}
+
+int ull_prepend_item(unrolled_list *list, void *item) {
+  return ull_insert_item(list, 0, item);
+}
+
+int ull_delete_at_index(unrolled_list *list, size_t index) {
+  if (!list)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+  if (list->length == 0)
+    return ULL_ERR_EMPTY;
+  if (index >= list->length)
+    return ULL_ERR_INDEX;
+
+  size_t pos;
+  ull_node *prev;
+  ull_node *node = ull_find(list, index, &pos, &prev);
+
+  memmove(ull_item(list, node, pos), ull_item(list, node, pos + 1),
+          (node->count - pos - 1) * list->item_size);
+  node->count--;
+  list->length--;
+
+  if (node->count == 0) {
+    if (prev == NULL)
+      list->head = node->next;
+    else
+      prev->next = node->next;
+    if (list->tail == node)
+      list->tail = prev;
+    free(node);
+    return ULL_SUCCESS;
+  }
+
+  // Keep nodes at least half full: merge with the next node when both fit in
+  // one, otherwise borrow enough items from it to even the two out.
+  ull_node *next = node->next;
+  if (next == NULL || node->count >= list->node_capacity / 2)
+    return ULL_SUCCESS;
+
+  if (node->count + next->count <= list->node_capacity) {
+    memcpy(ull_item(list, node, node->count), next->items,
+           next->count * list->item_size);
+    node->count += next->count;
+    node->next = next->next;
+    if (list->tail == next)
+      list->tail = node;
+    free(next);
+  } else {
+    size_t moved = (next->count - node->count) / 2;
+    memcpy(ull_item(list, node, node->count), next->items,
+           moved * list->item_size);
+    memmove(next->items, ull_item(list, next, moved),
+            (next->count - moved) * list->item_size);
+    node->count += moved;
+    next->count -= moved;
+  }
+
+  return ULL_SUCCESS;
+}
+
+int ull_delete_head(unrolled_list *list) {
+  return ull_delete_at_index(list, 0);
+}
+
+int ull_delete_tail(unrolled_list *list) {
+  if (!list)
+    return ULL_ERR_NULL;
+  if (list->length == 0)
+    return ULL_ERR_EMPTY;
+  return ull_delete_at_index(list, list->length - 1);
+}
+
+int ull_cursor_init(ull_cursor *cursor, unrolled_list *list) {
+  if (!cursor || !list)
+    return ULL_ERR_NULL;
+
+  cursor->list = list;
+  cursor->node = list->head;
+  cursor->pos = 0;
+  cursor->index = 0;
+  return ULL_SUCCESS;
+}
+
+// Points into the node at the item under the cursor, or is NULL at the end.
+void *ull_cursor_get_ptr(ull_cursor *cursor) {
+  if (!cursor || cursor->node == NULL)
+    return NULL;
+  return ull_item(cursor->list, cursor->node, cursor->pos);
+}
+
+int ull_cursor_next(ull_cursor *cursor) {
+  if (!cursor)
+    return ULL_ERR_NULL;
+
+  if (cursor->node == NULL)
+    return ULL_ERR_INDEX;
+
+  cursor->index++;
+  if (++cursor->pos == cursor->node->count) {
+    cursor->node = cursor->node->next;
+    cursor->pos = 0;
+  }
+  return ULL_SUCCESS;
+}
+
+/*
+ * Hands every node's items to `visit` in list order, a whole node at a time,
+ * so a scan costs one call per node rather than per item. `visit` may change
+ * the items but not the list.
+ */
+int ull_for_each(unrolled_list *list, ull_visit_fn visit, void *ctx) {
+  if (!list || !visit)
+    return ULL_ERR_NULL;
+  if (list->item_size == 0)
+    return ULL_ERR_UNINIT;
+
+  for (ull_node *node = list->head; node != NULL; node = node->next)
+    visit(node->items, node->count, ctx);
+  return ULL_SUCCESS;
+}
+
+void ull_free(unrolled_list *list) {
+  if (!list)
+    return;
+
+  ull_node *node = list->head;
+  while (node != NULL) {
+    ull_node *next = node->next;
+    free(node);
+    node = next;
+  }
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->length = 0;
+}
+
+#undef ull_item
+#undef ULL_MIN_CAPACITY
+#undef ULL_NODE_BYTES
+#undef ULL_CACHE_LINE
@@ -0,0 +1,66 @@
+/*
+ * @file: unrolled_linked_list.h
+ * @brief: Declares the unrolled linked list type and its functions.
+ */
+
+#ifndef UNROLLED_LINKED_LIST_H
+#define UNROLLED_LINKED_LIST_H
+
+#include <stddef.h>
+
+enum ull_errors {
+  ULL_SUCCESS = 0,
+  ULL_ERR_NULL,
+  ULL_ERR_INDEX,
+  ULL_ERR_UNINIT,
+  ULL_ERR_ALLOC,
+  ULL_ERR_EMPTY
+};
+
+typedef struct ull_node {
+  struct ull_node *next;
+  size_t count;
+  unsigned char items[];
+} ull_node;
+
+typedef struct unrolled_list {
+  ull_node *head;
+  ull_node *tail;
+  size_t item_size;
+  size_t node_capacity;
+  size_t node_bytes;
+  size_t length;
+} unrolled_list;
+
+/*
+ * A cursor walks the list item by item but node by node, so a full scan is
+ * O(n) and reads each node's items from consecutive memory. At the end of the
+ * list `node` is NULL. Changing the list invalidates it.
+ */
+typedef struct ull_cursor {
+  unrolled_list *list;
+  ull_node *node;
+  size_t pos;
+  size_t index;
+} ull_cursor;
+
+// Called by ull_for_each with each node's `count` items, stored contiguously.
+typedef void (*ull_visit_fn)(void *items, size_t count, void *ctx);
+
+char *ull_get_error_string(enum ull_errors error);
+int ull_init(unrolled_list *list, size_t item_size);
+int ull_get_item(unrolled_list *list, size_t index, void *item);
+int ull_set_item(unrolled_list *list, size_t index, void *item);
+int ull_append_item(unrolled_list *list, void *item);
+int ull_insert_item(unrolled_list *list, size_t index, void *item);
+int ull_prepend_item(unrolled_list *list, void *item);
+int ull_delete_at_index(unrolled_list *list, size_t index);
+int ull_delete_head(unrolled_list *list);
+int ull_delete_tail(unrolled_list *list);
+int ull_cursor_init(ull_cursor *cursor, unrolled_list *list);
+void *ull_cursor_get_ptr(ull_cursor *cursor);
+int ull_cursor_next(ull_cursor *cursor);
+int ull_for_each(unrolled_list *list, ull_visit_fn visit, void *ctx);
+void ull_free(unrolled_list *list);
+
+#endif /* ifndef UNROLLED_LINKED_LIST_H */